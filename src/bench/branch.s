@@ -0,0 +1,61 @@
+# MIT License
+#
+# Copyright (c) 2020 Davidson Francis <davidsondfgl@gmail.com>
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+#
+# Branch-heavy: total Collatz steps (n even: n/2, odd: 3n+1,
+# until 1) of every n in 1..100, left in r7. Branches depend
+# on the data, taken and not taken.
+#
+
+	movhi %r1, $0        # r1 = n (100)
+	movlo %r1, $100
+	mov   %r7, $0        # r7 = steps
+
+next:
+	mov %r2, %r1
+step:
+	cmp %r2, $1
+	je  done
+	mov %r3, %r2
+	and %r3, $1
+	jne odd
+
+	# Even: n / 2.
+	slr %r2, $1
+	add %r7, $1
+	j   step
+
+	# Odd: 3n + 1.
+odd:
+	mov %r3, %r2
+	add %r2, %r3
+	add %r2, %r3
+	add %r2, $1
+	add %r7, $1
+	j   step
+
+done:
+	sub %r1, $1
+	jne next
+
+halt:
+	j halt
@@ -0,0 +1,64 @@
+# MIT License
+#
+# Copyright (c) 2020 Davidson Francis <davidsondfgl@gmail.com>
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+#
+# Call/return: recursive fib(15), via jal and 'j %r7', with
+# the return address, n and fib(n-1) saved in a stack frame.
+# The result (610) is left in r2.
+#
+# Note: JAL always saves PC+1 in r7.
+#
+
+	movhi %r6, $0x0f     # r6 = stack pointer (0xf00)
+	mov   %r1, $15       # r1 = n
+	jal   fib
+
+halt:
+	j halt
+
+	# r2 = fib(r1)
+fib:
+	cmp %r1, $2
+	jlu base
+
+	sub %r6, $3          # push frame
+	sw  %r7, $0(%r6)
+	sw  %r1, $1(%r6)
+
+	sub %r1, $1          # fib(n-1)
+	jal fib
+	sw  %r2, $2(%r6)
+
+	lw  %r1, $1(%r6)     # fib(n-2)
+	sub %r1, $2
+	jal fib
+
+	lw  %r3, $2(%r6)
+	add %r2, %r3
+
+	lw  %r7, $0(%r6)     # pop frame
+	add %r6, $3
+	j   %r7
+
+base:
+	mov %r2, %r1
+	j   %r7
@@ -0,0 +1,51 @@
+# MIT License
+#
+# Copyright (c) 2020 Davidson Francis <davidsondfgl@gmail.com>
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+#
+# Memory copy: fills 512 words at 0x400 and copies them to 0x800,
+# one word per iteration.
+#
+
+	movhi %r1, $0x04     # r1 = source (0x400)
+	movhi %r2, $0x08     # r2 = destination (0x800)
+	movhi %r3, $0x02     # r3 = word count (512)
+
+	# Fill the source with count..1.
+	mov %r4, %r1
+	mov %r5, %r3
+fill:
+	sw  %r5, $0(%r4)
+	add %r4, $1
+	sub %r5, $1
+	jne fill
+
+	# Copy.
+copy:
+	lw  %r6, $0(%r1)
+	sw  %r6, $0(%r2)
+	add %r1, $1
+	add %r2, $1
+	sub %r3, $1
+	jne copy
+
+halt:
+	j halt
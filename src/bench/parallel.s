@@ -0,0 +1,67 @@
+# MIT License
+#
+# Copyright (c) 2020 Davidson Francis <davidsondfgl@gmail.com>
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+#
+# Parallel: 2048 independent work items (4 rounds of a 16-bit
+# xorshift, seeded with the item number), interleaved among the
+# cores of the multi-core SoC (ENABLE_MULTICORE): core r1 of r2
+# takes the items r1, r1+r2, r1+2*r2..., so that each core does
+# 1/r2 of the whole work. The per core checksum (sum of all the
+# results) is left in r3.
+#
+# With a single core (r2 == 0, no multi-core), runs all the items.
+#
+
+	cmp %r2, $0
+	jne start
+	mov %r2, $1          # Single core.
+
+start:
+	movhi %r4, $0x08     # r4 = items (2048)
+
+item:
+	cmp %r1, %r4         # Done?
+	jgeu halt
+
+	mov %r5, %r1         # r5 = x = item + 1
+	add %r5, $1
+	mov %r6, $4          # r6 = rounds
+
+round:
+	mov %r7, %r5
+	sll %r7, $7
+	xor %r5, %r7
+	mov %r7, %r5
+	slr %r7, $9
+	xor %r5, %r7
+	mov %r7, %r5
+	sll %r7, $8
+	xor %r5, %r7
+	sub %r6, $1
+	jne round
+
+	add %r3, %r5
+	add %r1, %r2         # Next item of this core.
+	j item
+
+halt:
+	j halt
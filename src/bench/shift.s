@@ -0,0 +1,47 @@
+# MIT License
+#
+# Copyright (c) 2020 Davidson Francis <davidsondfgl@gmail.com>
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+#
+# Shift-heavy: 2000 iterations of a 16-bit xorshift PRNG
+# (x ^= x << 7; x ^= x >> 9; x ^= x << 8), the state is
+# left in r1.
+#
+
+	mov   %r1, $1        # r1 = x
+	movhi %r6, $0x07     # r6 = 2000 (0x7d0)
+	movlo %r6, $0xd0
+
+loop:
+	mov %r2, %r1
+	sll %r2, $7
+	xor %r1, %r2
+	mov %r2, %r1
+	slr %r2, $9
+	xor %r1, %r2
+	mov %r2, %r1
+	sll %r2, $8
+	xor %r1, %r2
+	sub %r6, $1
+	jne loop
+
+halt:
+	j halt
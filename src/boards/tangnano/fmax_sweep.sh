@@ -0,0 +1,122 @@
+# MIT License
+#
+# Copyright (c) 2020 Davidson Francis <davidsondfgl@gmail.com>
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+#!/usr/bin/env bash
+
+#
+# Fmax sweep: builds the SoC with the PLL (see gen_tcl.sh) at each
+# one of the frequencies (in MHz) given in the command line, and
+# reports which ones close timing, i.e: the PLL clock Fmax reported
+# by the timing analysis is at least the generated frequency.
+#
+# Usage: fmax_sweep.sh <gw_sh> <MHz>...
+#
+
+CURDIR="$( cd "$(dirname "${BASH_SOURCE[0]}" )" >/dev/null 2>&1 && pwd )"
+SWEEPDIR="$CURDIR/output/fmax"
+
+if [ $# -lt 2 ]
+then
+	echo "Usage: $0 <gw_sh> <MHz>..." >&2
+	exit 1
+fi
+
+GWSH="$1"
+shift
+
+#
+# Reads the Fmax of the PLL clock from the timing report, i.e: the
+# 'Max Frequency Summary' row of PLL_CLK: '... PLL_CLK <target>(MHz)
+# <fmax>(MHz) ...'.
+#
+fmax_of()
+{
+	local report
+
+	report="$(ls "$1"/impl/pnr/Tangle.tr* 2>/dev/null | head -n 1)"
+	[ -n "$report" ] || return 1
+
+	sed 's/<[^>]*>/ /g' "$report" | awk '
+		/Max Frequency Summary/ { summary = 1 }
+		summary && /PLL_CLK/ {
+			n = 0
+			for (i = 1; i <= NF; i++)
+				if ($i ~ /^[0-9]+\.[0-9]+(\(MHz\))?$/)
+					mhz[++n] = $i + 0
+			if (n >= 2) {
+				print mhz[2]
+				exit
+			}
+		}'
+}
+
+best=""
+printf "%-10s %-12s %-12s %s\n" "Target" "PLL (MHz)" "Fmax (MHz)" "Status"
+
+for freq in "$@"
+do
+	out="$SWEEPDIR/$freq"
+	log="$out/build.log"
+	mkdir -p "$out"
+
+	# Build.
+	pll="$(OUTDIR="$out" TCLFILE="$out/gowin_synthesis_pnr.tcl" \
+		PLL_FREQ="$freq" bash "$CURDIR"/gen_tcl.sh 2>&1)" || {
+		printf "%-10s %-12s %-12s %s\n" "$freq" "-" "-" "no PLL setting"
+		continue
+	}
+	pll="$(echo "$pll" | awk '/^PLL:/ { print $2 }')"
+
+	if ! "$GWSH" "$out/gowin_synthesis_pnr.tcl" > "$log" 2>&1
+	then
+		printf "%-10s %-12s %-12s %s\n" "$freq" "$pll" "-" \
+			"build failed, see $log"
+		continue
+	fi
+
+	# Timing.
+	fmax="$(fmax_of "$out")"
+	if [ -z "$fmax" ]
+	then
+		status="unknown, see $out/impl/pnr"
+	elif awk -v a="$fmax" -v b="$pll" 'BEGIN { exit !(a >= b) }'
+	then
+		status="OK"
+		if [ -z "$best" ] || awk -v a="$freq" -v b="$best" \
+			'BEGIN { exit !(a > b) }'
+		then
+			best="$freq"
+		fi
+	else
+		status="FAIL"
+	fi
+
+	printf "%-10s %-12s %-12s %s\n" "$freq" "$pll" "${fmax:--}" "$status"
+done
+
+if [ -n "$best" ]
+then
+	echo "Fastest closing target: $best MHz (make build PLL_FREQ=$best)"
+else
+	echo "No target closed timing"
+	exit 1
+fi
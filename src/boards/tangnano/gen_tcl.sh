@@ -29,27 +29,134 @@ CURDIR="$( cd "$(dirname "${BASH_SOURCE[0]}" )" >/dev/null 2>&1 && pwd )"
 RTLDIR="$(readlink -f "$CURDIR"/../../rtl)"
 CFGDIR="$(readlink -f "$CURDIR"/configs)"
 
+#
+# Outputs, may be overridden (e.g: by fmax_sweep.sh)
+#
+OUTDIR="${OUTDIR:-$CURDIR/output}"
+TCLFILE="${TCLFILE:-$CURDIR/gowin_synthesis_pnr.tcl}"
+
+#
+# PLL: if PLL_FREQ (in MHz) is set, the SoC runs from the rPLL
+# (tangle_pll.v), at the nearest frequency it can generate, through
+# a generated top module.
+#
+PLL_FREQ="${PLL_FREQ:-}"
+FCLKIN=24
+
+SDCFILE="$CFGDIR/timing_constraints.sdc"
+
+if [ -n "$PLL_FREQ" ]
+then
+	# Dividers: PFD >= 3 MHz and VCO within 400-900 MHz (GW1N-1).
+	read -r IDIV FBDIV ODIV FOUT < <(awk -v fin="$FCLKIN" -v f="$PLL_FREQ" '
+	BEGIN {
+		n = split("2 4 8 16 32 48 64 80 96 112 128", odivs, " ")
+		best = -1
+		for (i = 0; i < 64; i++) {
+			if (fin / (i + 1) < 3)
+				break
+			for (fb = 0; fb < 64; fb++) {
+				fout = fin * (fb + 1) / (i + 1)
+				for (o = 1; o <= n; o++) {
+					vco = fout * odivs[o]
+					if (vco < 400 || vco > 900)
+						continue
+					err = (fout > f) ? fout - f : f - fout
+					if (best < 0 || err < best) {
+						best = err
+						bi = i; bfb = fb; bo = odivs[o]; bf = fout
+					}
+				}
+			}
+		}
+		if (best < 0)
+			exit 1
+		printf "%d %d %d %.3f\n", bi, bfb, bo, bf
+	}') || { echo "Unable to generate $PLL_FREQ MHz" >&2; exit 1; }
+
+	echo "PLL: $FOUT MHz (IDIV_SEL=$IDIV, FBDIV_SEL=$FBDIV, ODIV_SEL=$ODIV)"
+	mkdir -p "$OUTDIR"/src
+
+	# Top module: PLL + SoC, held in reset until the PLL locks.
+	cat > "$OUTDIR"/src/tangle_top.v <<-EOT
+	/* Generated by gen_tcl.sh, PLL_FREQ=$PLL_FREQ. */
+	module tangle_top
+		(
+			input clk_i,
+			input rst_i,
+			input uart_rx_i,
+			output led1,
+			output led2,
+			output led3
+		);
+
+		wire clk;
+		wire lock;
+
+		pll #(
+			.FCLKIN("$FCLKIN"),
+			.IDIV_SEL($IDIV),
+			.FBDIV_SEL($FBDIV),
+			.ODIV_SEL($ODIV)
+		) pll_unit (
+			.clk_i(clk_i),
+			.clk_o(clk),
+			.lock_o(lock)
+		);
+
+		/* Board reset is active low. */
+		tangle_soc #(
+			.CLK_FREQ($(awk -v f="$FOUT" 'BEGIN { printf "%d", f * 1e6 + 0.5 }'))
+		) soc_unit (
+			.clk_i(clk),
+			.rst_i(rst_i & lock),
+			.uart_rx_i(uart_rx_i),
+			.led1(led1),
+			.led2(led2),
+			.led3(led3)
+		);
+
+	endmodule
+	EOT
+
+	# Timing: the board clock and the PLL clock.
+	SDCFILE="$OUTDIR"/src/timing_constraints.sdc
+	{
+		cat "$CFGDIR"/timing_constraints.sdc
+		echo "create_generated_clock -name PLL_CLK -source [get_ports {clk_i}]" \
+			"-master_clock CLK -multiply_by $((FBDIV + 1))" \
+			"-divide_by $((IDIV + 1)) [get_pins {pll_unit/pll_unit/CLKOUT}]"
+	} > "$SDCFILE"
+fi
+
+
 # Initial file
 {
-	echo "set_option -out_dir $CURDIR/output"
+	echo "set_option -out_dir $OUTDIR"
 	echo "set_option -prj_name Tangle"
 	echo "set_option -synthesis_tool gowinsynthesis"
 	echo "set_option -device GW1N-1-QFN48-6"
 	echo "set_option -pn GW1N-LV1QN48C6/I5"
-} > "$CURDIR"/gowin_synthesis_pnr.tcl
+} > "$TCLFILE"
 
 # Iterate over each file
 files_list=("$RTLDIR"/*.v)
+if [ -n "$PLL_FREQ" ]
+then
+	files_list+=("$CURDIR"/tangle_pll.v "$OUTDIR"/src/tangle_top.v)
+	echo "set_option -top_module tangle_top" >> "$TCLFILE"
+fi
+
 for file in "${files_list[@]}"
 do
-	echo "add_file -verilog $file" >> "$CURDIR"/gowin_synthesis_pnr.tcl
+	echo "add_file -verilog $file" >> "$TCLFILE"
 done
 
 # Add remaining options
 {
 	echo "add_file -cst $CFGDIR/physical_constraints.cst"
-	echo "add_file -sdc $CFGDIR/timing_constraints.sdc"
+	echo "add_file -sdc $SDCFILE"
 	echo "add_file -cfg $CFGDIR/device.cfg"
 	echo "run_synthesis"
 	echo "run_pnr -tt -timing"
-} >> "$CURDIR"/gowin_synthesis_pnr.tcl
+} >> "$TCLFILE"
@@ -0,0 +1,87 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Davidson Francis <davidsondfgl@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Sipeed Tang Nano (GW1N-1) PLL
+ *
+ * rPLL in its static configuration: CLKOUT = FCLKIN * (FBDIV_SEL+1) /
+ * (IDIV_SEL+1), with a VCO at CLKOUT * ODIV_SEL. The dividers for a
+ * given frequency are chosen by gen_tcl.sh (PLL_FREQ), that also
+ * instantiates this module, in the generated top module.
+ */
+module pll
+	#(
+		parameter FCLKIN    = "24",
+		parameter IDIV_SEL  = 0,
+		parameter FBDIV_SEL = 0,
+		parameter ODIV_SEL  = 32
+	)
+	(
+		input  clk_i,
+		output clk_o,
+		output lock_o
+	);
+
+	rPLL #(
+		.FCLKIN(FCLKIN),
+		.DYN_IDIV_SEL("false"),
+		.IDIV_SEL(IDIV_SEL),
+		.DYN_FBDIV_SEL("false"),
+		.FBDIV_SEL(FBDIV_SEL),
+		.DYN_ODIV_SEL("false"),
+		.ODIV_SEL(ODIV_SEL),
+		.PSDA_SEL("0000"),
+		.DYN_DA_EN("false"),
+		.DUTYDA_SEL("1000"),
+		.CLKOUT_FT_DIR(1'b1),
+		.CLKOUTP_FT_DIR(1'b1),
+		.CLKOUT_DLY_STEP(0),
+		.CLKOUTP_DLY_STEP(0),
+		.CLKFB_SEL("internal"),
+		.CLKOUT_BYPASS("false"),
+		.CLKOUTP_BYPASS("false"),
+		.CLKOUTD_BYPASS("false"),
+		.DYN_SDIV_SEL(2),
+		.CLKOUTD_SRC("CLKOUT"),
+		.CLKOUTD3_SRC("CLKOUT"),
+		.DEVICE("GW1N-1")
+	) pll_unit (
+		.CLKOUT(clk_o),
+		.LOCK(lock_o),
+		.CLKOUTP(),
+		.CLKOUTD(),
+		.CLKOUTD3(),
+		.RESET(1'b0),
+		.RESET_P(1'b0),
+		.CLKIN(clk_i),
+		.CLKFB(1'b0),
+		.FBDSEL(6'b0),
+		.IDSEL(6'b0),
+		.ODSEL(6'b0),
+		.PSDA(4'b0),
+		.DUTYDA(4'b0),
+		.FDLY(4'b0)
+	);
+
+endmodule
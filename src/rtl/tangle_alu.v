@@ -56,7 +56,11 @@ module alu
 	reg cf_next;
 	reg of_next;
 
+`ifdef ENABLE_BARREL_SHIFTER
+	assign busy_o = 1'b0;
+`else
 	assign busy_o = (shifts != 0);
+`endif
 
 	always @(posedge clk_i, `RESET_EDGE rst_i)
 	begin
@@ -130,12 +134,21 @@ module alu
 				`MOVLO: begin
 					data_o = data1_i | data2_i;
 				end
+`ifdef ENABLE_BARREL_SHIFTER
+				`SLL: begin
+					data_o = data1_i << data2_i[3:0];
+				end
+				`SLR: begin
+					data_o = data1_i >> data2_i[3:0];
+				end
+`else
 				`SLL: begin
 					data_o = shift_out;
 				end
 				`SLR: begin
 					data_o = shift_out;
 				end
+`endif
 			endcase
 		end
 	end
@@ -157,7 +170,12 @@ module alu
 	 *
 	 * so, it would spend from 3 cycles (0 bit shift) to at most
 	 * (for 15 bits) 9 cycles to complete.
+	 *
+	 * If 'ENABLE_BARREL_SHIFTER' is defined, shifts are done in a
+	 * single cycle, like any other AMI instruction, and the ALU is
+	 * never busy.
 	 */
+`ifndef ENABLE_BARREL_SHIFTER
 	always @(posedge clk_i)
 	begin
 		if (wr_shift) begin
@@ -185,6 +203,7 @@ module alu
 			end
 		end
 	end
+`endif
 
 endmodule
 
@@ -206,10 +225,10 @@ module testbench_alu;
 	wire of_o;
 	wire alu_busy_o;
 
-	initial  begin
-		$dumpfile("alu.vcd");
-		$dumpvars;
-	end
+	/* Waveform dump, see tangle_dump.vh. */
+`define DUMP_NAME  "alu"
+`define DUMP_SCOPE testbench_alu
+`include "tangle_dump.vh"
 
 	alu alu_unit(
 		.clk_i(clk_i),
@@ -22,16 +22,161 @@
  * SOFTWARE.
  */
 
-/* Memory constants. */
-`define RAM_SIZE_LOG  6
+/*
+ * Multi-core SoC.
+ *
+ * Uncomment to instantiate NCORES CPUs, each one with its own memory
+ * bank (2^RAM_SIZE_LOG words), so that they never stall each other.
+ * All the banks are loaded with the same image (also by the UART
+ * loader) and each core finds, after reset, its ID in r1 and the
+ * core count in r2 (with ENABLE_REGFILE_SSRAM, only after the
+ * configuration). Core 0 drives the LEDs.
+ *
+ * Note: The GW1N-1 has 4k words of BSRAM, so NCORES * 2^RAM_SIZE_LOG
+ * must be at most 4096: unless given, RAM_SIZE_LOG defaults to the
+ * BSRAM split between the cores (see below), e.g: 11 for 2 cores and
+ * 10 for 3 or 4.
+ */
+//`define ENABLE_MULTICORE
+`ifndef NCORES
+`define NCORES 2
+`endif
+
+/*
+ * Memory constants.
+ *
+ * RAM_SIZE_LOG is the memory size (log2, in words) and *must* agree
+ * with RAM_SIZE_LOG in the toolchain (tas.h). The default (12 = 4k
+ * words, 8kB) uses the whole Sipeed Tang Nano BSRAM (4 blocks). It
+ * may be overridden in the command line, e.g: 'make sim RAM_SIZE_LOG=10'
+ * and 'make -C toolchain/assembler RAM_SIZE_LOG=10'.
+ *
+ * With ENABLE_MULTICORE, the default is 12 - clog2(NCORES) instead,
+ * and the toolchain must agree, e.g: 'tas -s 11' for 2 cores.
+ *
+ * Note: With ENABLE_PERF_COUNTERS, it must be at most 15, so that the
+ * counters stay above the RAM.
+ */
+`ifndef RAM_SIZE_LOG
+`ifdef ENABLE_MULTICORE
+`define RAM_SIZE_LOG (12 - $clog2(`NCORES))
+`else
+`define RAM_SIZE_LOG 12
+`endif
+`endif
 `define RAM_WIDTH    16
 
+/*
+ * CPU implementation.
+ *
+ * By default, Tangle uses a multi-state FSM, which spends at least
+ * 3 clocks per instruction. Uncomment (or define it in the command
+ * line) to use the 2-stage pipeline instead, which runs straight-line
+ * code at 1 instruction per clock, at the cost of a few more LUTs.
+ */
+//`define ENABLE_PIPELINE
+
+/*
+ * Memory ports.
+ *
+ * Uncomment to use a dual-port memory: a read-only port for the
+ * instruction fetch and a read/write port for loads and stores, so
+ * that memory accesses do not compete with the fetch.
+ */
+//`define ENABLE_DUAL_PORT_RAM
+
+/*
+ * Shifter.
+ *
+ * By default, SLL/SLR use an iterative shifter (4 bits or 1 bit per
+ * clock), that may take up to 6 extra clocks. Uncomment to use a
+ * single-cycle barrel shifter instead, for some extra LUTs.
+ */
+//`define ENABLE_BARREL_SHIFTER
+
+/*
+ * Static branch prediction (FSM CPU only).
+ *
+ * Uncomment to predict, while the previous instruction writes back,
+ * immediate jumps (J/JAL) and backward conditional branches as taken,
+ * so that their target is fetched in advance. Correctly predicted
+ * branches take 3 clocks (instead of 4), but mispredicted backward
+ * branches (i.e: loop exits) take 4 clocks (instead of 3).
+ */
+//`define ENABLE_BRANCH_PREDICTION
+
+/*
+ * Register file.
+ *
+ * Uncomment ENABLE_REGFILE_BYPASS to add a second, write-first, write
+ * port to the register file, so that the load write back overlaps the
+ * next instruction. In the FSM CPU, the write-back state is then only
+ * used by taken branches and single-port stores: ALU instructions and
+ * not taken branches take 2 clocks (instead of 3) and loads, 3 (2 with
+ * the dual-port memory). In the pipeline, loads no longer stall the
+ * next instruction with the dual-port memory (1 clock).
+ *
+ * Uncomment ENABLE_REGFILE_SSRAM to map the register file into
+ * distributed RAM (SSRAM) instead of flip-flops. It has a single write
+ * port, so it is ignored with the bypass. Note that the registers are
+ * then no longer cleared by the reset button.
+ */
+//`define ENABLE_REGFILE_BYPASS
+//`define ENABLE_REGFILE_SSRAM
+
+`ifdef ENABLE_REGFILE_BYPASS
+`undef ENABLE_REGFILE_SSRAM
+`endif
+
+/*
+ * Performance counters.
+ *
+ * Uncomment to add cycle, retired instructions, memory stall and ALU
+ * stall counters (32-bit each, see tangle_perf.v). They are read-only
+ * and mapped above the RAM, at PERF_BASE, two words per counter (low
+ * word first), so they are reachable with:
+ *   lw %rX, $-16(%r0) # cycles, low
+ *   ...
+ *   lw %rX, $-9(%r0)  # ALU stalls, high
+ *
+ * Stores to the counters are ignored.
+ */
+//`define ENABLE_PERF_COUNTERS
+`define PERF_BASE 16'hFFF0
+`define PERF_MASK 16'hFFF8
+
+`define PERF_CYCLES     2'd0
+`define PERF_RETIRED    2'd1
+`define PERF_MEM_STALLS 2'd2
+`define PERF_ALU_STALLS 2'd3
+
+/*
+ * UART bootloader.
+ *
+ * Uncomment to add a UART receiver (8N1, at UART_BAUD, pin 'uart_rx_i')
+ * and a loader to the SoC, so that programs can be loaded at runtime
+ * ('make load PROG=<file.s>'), without a new synthesis. The program in
+ * the bitstream runs as usual until a LOADER_SYNC byte arrives, then
+ * the CPU is held in reset while the loader reads:
+ *   LOADER_SYNC, count (16-bit), count words
+ * all little-endian (i.e: 'tas -f binle'), into the memory from the
+ * address 0, and the CPU is released.
+ *
+ * CLK_FREQ is the SoC clock (in Hz) without the PLL, i.e: the board
+ * clock, with the PLL (see boards/tangnano), it is set by the board.
+ */
+//`define ENABLE_UART_LOADER
+`define CLK_FREQ    24000000
+`define UART_BAUD   115200
+`define LOADER_SYNC 8'h54 /* 'T'. */
+
 /* Default HW reset behaviour.
  * This *must* be double checked if used in others boards
  * besides Sipeed Tang Nano.
  */
 `define HW_RESET_EDGE negedge
 `define HW_ISRESET(rst_pin) (!(rst_pin))
+`define HW_RESET_LEVEL 1'b0
 
 /*
  * Is RESET button enabled at pos or negedge?
@@ -42,13 +187,16 @@
 	`ifndef ENABLE_TESTBENCHS
 		`define RESET_EDGE `HW_RESET_EDGE
 		`define IS_RESET `HW_ISRESET
+		`define RESET_LEVEL `HW_RESET_LEVEL
 	`else
 		`define RESET_EDGE posedge
 		`define IS_RESET(rst_pin) rst_pin
+		`define RESET_LEVEL 1'b1
 	`endif
 `else
 	`define RESET_EDGE posedge
 	`define IS_RESET(rst_pin) rst_pin
+	`define RESET_LEVEL 1'b1
 `endif
 
 /*
@@ -26,8 +26,20 @@
 
 /*
  * Tangle CPU.
+ *
+ * Multi-state FSM, the default (and smaller) CPU. If 'ENABLE_PIPELINE'
+ * is defined, the pipelined version (tangle_cpu_pipeline.v) is used
+ * instead.
+ *
+ * @p CORE_ID and @p NCORES are only used in the multi-core SoC
+ * (ENABLE_MULTICORE).
  */
+`ifndef ENABLE_PIPELINE
 module cpu
+	#(
+		parameter CORE_ID = 0,
+		parameter NCORES  = 1
+	)
 	(
 		input  clk_i,
 		input  rst_i,
@@ -35,6 +47,10 @@ module cpu
 		output [15:0] mem_data_i,
 		output [15:0] mem_addr_i,
 		output mem_we,
+`ifdef ENABLE_DUAL_PORT_RAM
+		input  [15:0] fetch_data_o,
+		output [15:0] fetch_addr_i,
+`endif
 		output dbg_zf,
 		output dbg_sf,
 		output dbg_cf
@@ -45,6 +61,17 @@ module cpu
 	reg  [15:0] mem_addr;
 	reg  [15:0] insn_i;
 	reg  [15:0] next_insn;
+	wire [15:0] insn_data;
+	wire [15:0] fetched;
+
+	// Load write back (register file bypass)
+	reg  load_pending;
+	reg  [2:0]  load_reg;
+
+	// Performance counters
+	reg  perf_hit;
+	reg  [2:0]  perf_sel;
+	wire [15:0] perf_data;
 
 	// Decode wires
 	wire zf_o;
@@ -88,10 +115,110 @@ module cpu
 	wire [`RAM_SIZE_LOG-1:0] PCplus2    = pc + 1'd1;
 	wire [`RAM_SIZE_LOG-1:0] PCplus_imm = pc + imm_o[`RAM_SIZE_LOG-1:0];
 
-	/* Memory wires. */
-	assign mem_we = (state == `STATE_WRITEBACK ? memwe_o : 1'b0);
+	/*
+	 * Lookahead: the next instruction (la_insn, at la_pc), about to
+	 * be decoded. It is 'next_insn' in the write-back, or, if the
+	 * write-back is skipped (see 'fast_wb'), the instruction just
+	 * fetched.
+	 */
+	wire [15:0] la_insn = (state == `STATE_WRITEBACK) ? next_insn : fetched;
+	wire [`RAM_SIZE_LOG-1:0] la_pc =
+		(state == `STATE_EXECUTE || state == `STATE_WAIT_ALU) ? PCplus2 : pc;
+	wire [`RAM_SIZE_LOG-1:0] la_next = la_pc + 1'd1;
+
+	/*
+	 * Static branch prediction.
+	 *
+	 * While the lookahead instruction is about to be fetched: if it
+	 * is an immediate jump or a backward conditional branch, it is
+	 * predicted as taken and its target is fetched right away,
+	 * instead of PC+1. If the branch is really taken, the target is
+	 * already available in the execute state, and the STATE_WAIT_MEM
+	 * bubble is skipped. Otherwise, PC+1 is fetched in the insn fetch
+	 * and waited in STATE_WAIT_MEM.
+	 */
+	reg predicted;
+`ifdef ENABLE_BRANCH_PREDICTION
+	wire [15:0] predict_imm = { {8{la_insn[7]}}, la_insn[7:0] };
+	wire [`RAM_SIZE_LOG-1:0] predict_pc = la_pc + predict_imm[`RAM_SIZE_LOG-1:0];
+	wire predict = (
+		la_insn[15:11] >= `TANGLE_OPCODE_JE  &&
+		la_insn[15:11] <= `TANGLE_OPCODE_JAL &&
+		la_insn[10:8]  == 3'b0 &&
+		(la_insn[15:11] == `TANGLE_OPCODE_J   ||
+		 la_insn[15:11] == `TANGLE_OPCODE_JAL ||
+		 la_insn[7])
+	);
+`else
+	wire predict = 1'b0;
+	wire [`RAM_SIZE_LOG-1:0] predict_pc = la_next;
+`endif
+
+	/*
+	 * Write-back overlapped with the next fetch.
+	 *
+	 * With the register file bypass, loads write back through the
+	 * second register file port while the next instruction is in
+	 * STATE_INSN_FETCH (and reads the loaded value through the
+	 * bypass). Everything else that does not need the write-back
+	 * state (ALU results are written in the execute/wait ALU states)
+	 * goes straight to the next instruction fetch, i.e: all but
+	 * taken/mispredicted branches and single-port stores.
+	 */
+`ifdef ENABLE_REGFILE_BYPASS
+`ifdef ENABLE_DUAL_PORT_RAM
+	wire fast_mem = 1'b1;
+`else
+	wire fast_mem = (insntype_o != `INSN_MEM_LW && insntype_o != `INSN_MEM_SW);
+`endif
+	wire fast_wb = (
+		(state == `STATE_EXECUTE && nextpc_o == `INSN_PC_INC &&
+			!predicted && !alu_busy && fast_mem) ||
+		(state == `STATE_WAIT_ALU && !alu_busy) ||
+		(state == `STATE_WAIT_MEM && insntype_o == `INSN_MEM_LW)
+	);
+`else
+	wire fast_wb = 1'b0;
+`endif
+
+	/*
+	 * Performance counters window, loads/stores addresses are
+	 * latched (perf_hit/perf_sel) in the execute state.
+	 */
+`ifdef ENABLE_PERF_COUNTERS
+	wire perf_addr = ((alu_out & `PERF_MASK) == `PERF_BASE);
+`else
+	wire perf_addr = 1'b0;
+`endif
+
+	/*
+	 * Memory wires.
+	 *
+	 * With a dual-port memory, 'mem_addr' only fetches instructions,
+	 * and loads/stores access the data port straight from the ALU,
+	 * in the execute state.
+	 */
+`ifdef ENABLE_DUAL_PORT_RAM
+	assign mem_we = (state == `STATE_EXECUTE && !perf_addr ? memwe_o : 1'b0);
+	assign mem_data_i = reg_data1;
+	assign mem_addr_i = alu_out;
+	assign fetch_addr_i = mem_addr;
+	assign insn_data = fetch_data_o;
+`else
+	assign mem_we = (state == `STATE_WRITEBACK && !perf_hit ? memwe_o : 1'b0);
 	assign mem_data_i = reg_data1;
 	assign mem_addr_i = mem_addr;
+	assign insn_data = mem_data_o;
+`endif
+
+	/*
+	 * If store _and_ if the next instruction have the same address
+	 * as the store instruction, the next instruction is the store
+	 * content. Otherwise, just the data available from memory.
+	 */
+	assign fetched =
+		(insntype_o == `INSN_MEM_SW && alu_out == PCplus2) ? reg_data1 :
+		insn_data;
 
 	/* Debug pin. */
 	assign dbg_zf = zf_o;
@@ -116,14 +243,29 @@ module cpu
 		.aluen_o(aluen_o)
 	);
 
-	/* Register file. */
-	register_file register_file_unit(
+	/*
+	 * Register file, in the multi-core SoC, r1 and r2 hold the
+	 * core ID and count after reset.
+	 */
+	register_file
+`ifdef ENABLE_MULTICORE
+	#(
+		.R1_RESET(CORE_ID),
+		.R2_RESET(NCORES)
+	)
+`endif
+	register_file_unit(
 		.clk_i(clk_i),
 		.rst_i(rst_i),
 		.we_i(reg_we),
 		.reg1_i(insntype_o != `INSN_BRA_JAL ? regdst_o : 3'b111),
 		.reg2_i(regsrc_o),
 		.data_i(reg_input),
+`ifdef ENABLE_REGFILE_BYPASS
+		.we2_i(load_pending),
+		.reg3_i(load_reg),
+		.data3_i(perf_hit ? perf_data : mem_data_o),
+`endif
 		.data1_o(reg_data1),
 		.data2_o(reg_data2)
 	);
@@ -159,9 +301,29 @@ module cpu
 	assign reg_input = (
 		(insntype_o == `INSN_AMI_REGREG || insntype_o == `INSN_AMI_REGIMM) ? alu_out :
 		(insntype_o == `INSN_BRA_JAL) ? PCplus2 :
+		perf_hit ? perf_data :
 		mem_data_o
 	);
 
+	/* Performance counters. */
+`ifdef ENABLE_PERF_COUNTERS
+	perf perf_unit(
+		.clk_i(clk_i),
+		.rst_i(rst_i),
+		.retire_i(state == `STATE_WRITEBACK || fast_wb),
+`ifdef ENABLE_REGFILE_BYPASS
+		.mem_stall_i(state == `STATE_WAIT_MEM || state == `STATE_WRITEBACK),
+`else
+		.mem_stall_i(state == `STATE_WAIT_MEM),
+`endif
+		.alu_stall_i(state == `STATE_WAIT_ALU),
+		.sel_i(perf_sel),
+		.data_o(perf_data)
+	);
+`else
+	assign perf_data = 16'h0;
+`endif
+
 	/* CPU state machine. */
 	always @(posedge clk_i, `RESET_EDGE rst_i)
 	begin
@@ -171,10 +333,17 @@ module cpu
 			insn_i    <= 0;
 			next_insn <= 0;
 			mem_addr  <= 0;
+			perf_hit  <= 1'b0;
+			perf_sel  <= 3'b0;
+			predicted <= 1'b0;
+			load_pending <= 1'b0;
+			load_reg     <= 3'b0;
 			state     <= `STATE_IDLE;
 		end
 
 		else begin
+			load_pending <= 1'b0;
+
 			case (state)
 				/* Initial states. */
 				`STATE_IDLE: begin
@@ -182,8 +351,8 @@ module cpu
 				end
 				`STATE_WAIT: begin
 					mem_addr  <= PCplus2;
-					insn_i    <= mem_data_o;
-					next_insn <= mem_data_o;
+					insn_i    <= insn_data;
+					next_insn <= insn_data;
 					state     <= `STATE_INSN_FETCH;
 				end
 
@@ -206,6 +375,12 @@ module cpu
 						`INSN_PC_REG: begin
 							mem_addr <= reg_data1;
 						end
+
+						/* Mispredicted: fetch PC+1 instead. */
+						default: begin
+							if (predicted)
+								mem_addr <= PCplus2;
+						end
 					endcase
 
 					/* Go to execute. */
@@ -215,22 +390,35 @@ module cpu
 				/* Decode/execute. */
 				`STATE_EXECUTE: begin
 
+					perf_hit <= perf_addr;
+					perf_sel <= alu_out[2:0];
+
 					/* Adjusts PC and next state. */
 					case (nextpc_o)
 
-						/* If taken branch. */
+						/*
+						 * If taken branch, the target is already
+						 * available if predicted.
+						 */
 						`INSN_PC_IMM: begin
 							pc    <= PCplus_imm;
-							state <= `STATE_WAIT_MEM;
+							state <= predicted ? `STATE_WRITEBACK :
+								`STATE_WAIT_MEM;
 						end
 						`INSN_PC_REG: begin
 							pc    <= reg_data1[`RAM_SIZE_LOG-1:0];
 							state <= `STATE_WAIT_MEM;
 						end
 
-						/* If normal execution, go to writeback. */
+						/* Mispredicted branch, wait for PC+1. */
 						default: begin
-							if (alu_busy != 1'b1) begin
+							if (predicted) begin
+								pc    <= PCplus2;
+								state <= `STATE_WAIT_MEM;
+							end
+
+							/* If normal execution, go to writeback. */
+							else if (alu_busy != 1'b1) begin
 								pc    <= PCplus2;
 								state <= `STATE_WRITEBACK;
 							end else begin
@@ -242,33 +430,30 @@ module cpu
 					/*
 					 * Load or store.
 					 *
-					 * If store _and_ if the next instruction have the same
-					 * address as the store instruction, set the next
-					 * instruction value to be the store content. Otherwise,
-					 * next instruction will just be the data available from
-					 * memory in the next clock.
+					 * If store over the next instruction, 'fetched'
+					 * is the store content.
 					 */
+					next_insn <= fetched;
+
+`ifndef ENABLE_DUAL_PORT_RAM
 					if (insntype_o == `INSN_MEM_LW || insntype_o == `INSN_MEM_SW)
 					begin
+						/*
+						 * Single port: the load result is only available
+						 * after the address gets into the memory.
+						 */
 						mem_addr <= alu_out;
 
 						if (insntype_o == `INSN_MEM_LW)
 							state <= `STATE_WAIT_MEM;
-
-						if (insntype_o == `INSN_MEM_SW && alu_out == PCplus2)
-							next_insn <= reg_data1;
-						else
-							next_insn <= mem_data_o;
-
-					end else begin
-						next_insn <= mem_data_o;
 					end
+`endif
 
 				end
 
 				/* Memory. */
 				`STATE_WAIT_MEM: begin
-					next_insn <= mem_data_o;
+					next_insn <= insn_data;
 					state     <= `STATE_WRITEBACK;
 				end
 
@@ -283,13 +468,32 @@ module cpu
 				/* Write-back. */
 				`STATE_WRITEBACK: begin
 
-					/* Lookahead our next instruction. */
-					insn_i   <= next_insn;
-					mem_addr <= PCplus2;
-					state    <= `STATE_INSN_FETCH;
+					/*
+					 * Lookahead our next instruction, or its
+					 * target, if predicted as taken.
+					 */
+					insn_i    <= la_insn;
+					mem_addr  <= predict ? predict_pc : la_next;
+					predicted <= predict;
+					state     <= `STATE_INSN_FETCH;
 				end
 
 			endcase
+
+			/*
+			 * Skip the write-back, the next instruction is already
+			 * available (see 'fast_wb'), loads are written back in
+			 * the next clock.
+			 */
+			if (fast_wb) begin
+				insn_i       <= la_insn;
+				mem_addr     <= predict ? predict_pc : la_next;
+				predicted    <= predict;
+				load_pending <= (insntype_o == `INSN_MEM_LW);
+				load_reg     <= regdst_o;
+				state        <= `STATE_INSN_FETCH;
+			end
 		end
 	end
 endmodule
+`endif
@@ -0,0 +1,440 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Davidson Francis <davidsondfgl@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+`include "tangle_config.v"
+
+/*
+ * Tangle CPU, pipelined version.
+ *
+ * This is a drop-in replacement for the multi-state FSM CPU, enabled
+ * with 'ENABLE_PIPELINE' (see tangle_config.v). Instructions flow
+ * through 2 stages:
+ *
+ * - Fetch: the instruction address is presented to the memory, which
+ *   answers in the next clock.
+ *
+ * - Execute: decodes the instruction straight from the memory output,
+ *   reads the registers, executes and writes back, all within the same
+ *   clock. Since the register file reads are asynchronous and the
+ *   writes happen at the end of this stage, the next instruction
+ *   already sees the results, no bypass/forwarding is needed between
+ *   ALU instructions.
+ *
+ * While an instruction executes, the next one is being fetched, i.e:
+ * straight-line code runs at 1 instruction per clock.
+ *
+ * Hazards:
+ * --------
+ * - Memory (structural): there is a single memory port, so loads and
+ *   stores use it in the execute stage (instead of the fetch), and the
+ *   load result is written back in the next clock, while the next
+ *   instruction is fetched.
+ *
+ * - Taken branches (control): the already fetched instruction (PC+1)
+ *   is squashed and the target is fetched in the next clock.
+ *
+ * - Shifts (ALU busy): the instruction is kept in execute, by
+ *   re-fetching it, until the iterative shifter finishes.
+ *
+ * Clock notes:
+ * ------------
+ * AMI instructions: 1 cycle
+ * Not taken jumps: 1 cycle
+ * Taken jumps: 2 cycles
+ * Load/Store: 2 cycles
+ * Shifts: 2 cycles + shift_amt/4 + shift_amt%4 (1 cycle with the
+ *         barrel shifter)
+ *
+ * Note: Stores no longer need to patch the next instruction (as in
+ * the FSM CPU), since the next instruction is only fetched after the
+ * store.
+ *
+ * Dual-port memory:
+ * -----------------
+ * With 'ENABLE_DUAL_PORT_RAM', instructions are fetched from their own
+ * port and loads/stores no longer take the fetch slot:
+ *
+ * - Stores: 1 cycle. If the store hits the instruction being fetched,
+ *   the latter is squashed and fetched again.
+ *
+ * - Loads: 2 cycles, the next instruction is fetched in parallel, but
+ *   waits one clock in execute, while the load is written back.
+ *
+ * Register file bypass:
+ * ---------------------
+ * With 'ENABLE_REGFILE_BYPASS', loads are written back through the
+ * second register file port, and the next instruction reads the loaded
+ * value through its write-first bypass: with the dual-port memory,
+ * loads take 1 cycle and never stall the next instruction.
+ */
+`ifdef ENABLE_PIPELINE
+module cpu
+	#(
+		parameter CORE_ID = 0,
+		parameter NCORES  = 1
+	)
+	(
+		input  clk_i,
+		input  rst_i,
+		input  [15:0] mem_data_o,
+		output [15:0] mem_data_i,
+		output [15:0] mem_addr_i,
+		output mem_we,
+`ifdef ENABLE_DUAL_PORT_RAM
+		input  [15:0] fetch_data_o,
+		output [15:0] fetch_addr_i,
+`endif
+		output dbg_zf,
+		output dbg_sf,
+		output dbg_cf
+	);
+
+	reg  [`RAM_SIZE_LOG-1:0] pc;       /* Execute stage PC.       */
+	reg  [`RAM_SIZE_LOG-1:0] fetch_pc; /* Next instruction fetch. */
+	reg  ex_valid;                     /* Execute stage is valid. */
+	reg  shift_started;                /* Shifter already loaded. */
+	reg  load_pending;                 /* Load data arriving.     */
+	reg  [2:0] load_reg;               /* Load destination.       */
+	reg  load_perf;                    /* Load from perf counter. */
+	reg  [2:0] load_sel;               /* Perf counter word.      */
+	wire [15:0] perf_data;
+
+	// Decode wires
+	wire zf_o;
+	wire sf_o;
+	wire cf_o;
+	wire of_o;
+	wire  [2:0] regdst_o;
+	wire  [2:0] regsrc_o;
+	wire  [1:0] nextpc_o;
+	wire  [2:0] insntype_o;
+	wire  [3:0] aluop_o;
+	wire [15:0] imm_o;
+	wire  regwe_o;
+	wire  memwe_o;
+	wire  aluen_o;
+
+	// Reg file wires
+	wire [15:0] reg_data1;
+	wire [15:0] reg_data2;
+	wire [15:0] reg_input;
+	wire  [2:0] reg_dst;
+
+	// Alu
+	wire [15:0] alu_out;
+	wire [15:0] alu_data1;
+	wire [15:0] alu_data2;
+	wire alu_busy;
+
+	/* Execute stage instruction, straight from the memory. */
+`ifdef ENABLE_DUAL_PORT_RAM
+	wire [15:0] insn_data = fetch_data_o;
+`else
+	wire [15:0] insn_data = mem_data_o;
+`endif
+	wire [15:0] insn_i = ex_valid ? insn_data : 16'h0;
+
+	/* Execute stage status. */
+	wire is_mem = ex_valid &&
+		(insntype_o == `INSN_MEM_LW || insntype_o == `INSN_MEM_SW);
+
+	wire is_shift = ex_valid && aluen_o &&
+		(aluop_o == `SLL || aluop_o == `SLR);
+
+`ifdef ENABLE_BARREL_SHIFTER
+	wire shift_wait = 1'b0;
+`else
+	wire shift_wait = is_shift && (!shift_started || alu_busy);
+`endif
+
+	/*
+	 * Load write back while the next instruction is already in
+	 * execute (dual-port only): the register file write port is busy,
+	 * unless the load has its own port (bypass).
+	 */
+`ifdef ENABLE_REGFILE_BYPASS
+	wire load_stall = 1'b0;
+`else
+	wire load_stall = load_pending && ex_valid;
+`endif
+
+	/* Keep the current instruction in execute. */
+	wire hold = shift_wait || load_stall;
+
+	/* Store to the instruction being fetched (dual-port only). */
+	wire store_hit = ex_valid && insntype_o == `INSN_MEM_SW &&
+		alu_out[`RAM_SIZE_LOG-1:0] == fetch_pc;
+
+	wire is_taken = ex_valid && nextpc_o != `INSN_PC_INC;
+
+	/* Next PC and PC w/ imm jump. */
+	wire [`RAM_SIZE_LOG-1:0] PCplus2    = pc + 1'd1;
+	wire [`RAM_SIZE_LOG-1:0] PCplus_imm = pc + imm_o[`RAM_SIZE_LOG-1:0];
+
+	// Alu enable
+	wire alu_en = (aluen_o && ex_valid && !load_stall);
+
+	/*
+	 * Reg write-enable: loads write back in the next clock, everything
+	 * else when leaves the execute stage.
+	 */
+	wire ex_write = ex_valid && !hold && insntype_o != `INSN_MEM_LW;
+	wire [15:0] load_data = load_perf ? perf_data : mem_data_o;
+
+`ifdef ENABLE_REGFILE_BYPASS
+	wire reg_we = (ex_write ? regwe_o : 1'b0);
+
+	assign reg_dst =
+		insntype_o != `INSN_BRA_JAL ? regdst_o : 3'b111;
+`else
+	wire reg_we = load_pending ? 1'b1 :
+		(ex_write ? regwe_o : 1'b0);
+
+	assign reg_dst =
+		load_pending ? load_reg :
+		insntype_o != `INSN_BRA_JAL ? regdst_o : 3'b111;
+`endif
+
+	/*
+	 * Performance counters window, the load address is latched
+	 * (load_perf/load_sel) for the load write back.
+	 */
+`ifdef ENABLE_PERF_COUNTERS
+	wire perf_addr = ((alu_out & `PERF_MASK) == `PERF_BASE);
+`else
+	wire perf_addr = 1'b0;
+`endif
+
+	/* Memory wires. */
+`ifdef ENABLE_DUAL_PORT_RAM
+	assign mem_we = (is_mem && !hold && !perf_addr ? memwe_o : 1'b0);
+	assign mem_data_i = reg_data1;
+	assign mem_addr_i = alu_out;
+	assign fetch_addr_i =
+		hold ? {{(16-`RAM_SIZE_LOG){1'b0}}, pc} :
+		{{(16-`RAM_SIZE_LOG){1'b0}}, fetch_pc};
+`else
+	assign mem_we = (is_mem && !perf_addr ? memwe_o : 1'b0);
+	assign mem_data_i = reg_data1;
+	assign mem_addr_i =
+		is_mem ? alu_out :
+		hold   ? {{(16-`RAM_SIZE_LOG){1'b0}}, pc} :
+		{{(16-`RAM_SIZE_LOG){1'b0}}, fetch_pc};
+`endif
+
+	/* Debug pin. */
+	assign dbg_zf = zf_o;
+	assign dbg_sf = sf_o;
+	assign dbg_cf = cf_o;
+
+	/* Decode. */
+	decode decode_unit(
+		.insn_i(insn_i),
+		.zf_i(zf_o),
+		.sf_i(sf_o),
+		.cf_i(cf_o),
+		.of_i(of_o),
+		.regdst_o(regdst_o),
+		.regsrc_o(regsrc_o),
+		.nextpc_o(nextpc_o),
+		.insntype_o(insntype_o),
+		.aluop_o(aluop_o),
+		.imm_o(imm_o),
+		.regwe_o(regwe_o),
+		.memwe_o(memwe_o),
+		.aluen_o(aluen_o)
+	);
+
+	/*
+	 * Register file, in the multi-core SoC, r1 and r2 hold the
+	 * core ID and count after reset.
+	 */
+	register_file
+`ifdef ENABLE_MULTICORE
+	#(
+		.R1_RESET(CORE_ID),
+		.R2_RESET(NCORES)
+	)
+`endif
+	register_file_unit(
+		.clk_i(clk_i),
+		.rst_i(rst_i),
+		.we_i(reg_we),
+		.reg1_i(reg_dst),
+		.reg2_i(regsrc_o),
+		.data_i(reg_input),
+`ifdef ENABLE_REGFILE_BYPASS
+		.we2_i(load_pending),
+		.reg3_i(load_reg),
+		.data3_i(load_data),
+`endif
+		.data1_o(reg_data1),
+		.data2_o(reg_data2)
+	);
+
+	/* Alu. */
+	alu alu_unit(
+		.clk_i(clk_i),
+		.rst_i(rst_i),
+		.op_i(aluop_o),
+		.data1_i(alu_data1),
+		.data2_i(alu_data2),
+		.alu_en(alu_en),
+		.wr_shift(is_shift && !shift_started),
+		.data_o(alu_out),
+		.zf_o(zf_o),
+		.sf_o(sf_o),
+		.cf_o(cf_o),
+		.of_o(of_o),
+		.busy_o(alu_busy)
+	);
+
+	/* Some inputs. */
+	assign alu_data1 = (
+		insntype_o == `INSN_AMI_REGREG ? reg_data1 :
+		insntype_o == `INSN_AMI_REGIMM ? reg_data1 :
+		insntype_o == `INSN_MEM_LW ? reg_data2 :
+		insntype_o == `INSN_MEM_SW ? reg_data2 :
+		reg_data1
+	);
+	assign alu_data2 = (
+		insntype_o == `INSN_AMI_REGREG ? reg_data2 : imm_o
+	);
+	assign reg_input = (
+`ifndef ENABLE_REGFILE_BYPASS
+		load_pending ? load_data :
+`endif
+		(insntype_o == `INSN_AMI_REGREG || insntype_o == `INSN_AMI_REGIMM) ? alu_out :
+		(insntype_o == `INSN_BRA_JAL) ? PCplus2 :
+		mem_data_o
+	);
+
+	/*
+	 * Performance counters: loads retire when written back (or when
+	 * leave the execute stage, with the bypass, as their write back
+	 * may overlap the next instruction), memory stalls are the empty
+	 * execute stage clocks and the load write backs.
+	 */
+`ifdef ENABLE_REGFILE_BYPASS
+	wire retire = ex_valid && !hold;
+`else
+	wire retire = ex_write || load_pending;
+`endif
+
+`ifdef ENABLE_PERF_COUNTERS
+	perf perf_unit(
+		.clk_i(clk_i),
+		.rst_i(rst_i),
+		.retire_i(retire),
+		.mem_stall_i(!ex_valid || load_stall),
+		.alu_stall_i(ex_valid && !load_stall && shift_wait),
+		.sel_i(load_sel),
+		.data_o(perf_data)
+	);
+`else
+	assign perf_data = 16'h0;
+`endif
+
+	/* Pipeline control. */
+	always @(posedge clk_i, `RESET_EDGE rst_i)
+	begin
+
+		if (`IS_RESET(rst_i)) begin
+			pc            <= 0;
+			fetch_pc      <= 0;
+			ex_valid      <= 1'b0;
+			shift_started <= 1'b0;
+			load_pending  <= 1'b0;
+			load_reg      <= 3'b0;
+			load_perf     <= 1'b0;
+			load_sel      <= 3'b0;
+		end
+
+		else begin
+			load_pending <= 1'b0;
+			load_perf    <= perf_addr;
+			load_sel     <= alu_out[2:0];
+
+			/* Empty execute stage: just fetched the next instruction. */
+			if (!ex_valid) begin
+				pc       <= fetch_pc;
+				fetch_pc <= fetch_pc + 1'd1;
+				ex_valid <= 1'b1;
+			end
+
+			/* Load write back: keep the instruction. */
+			else if (load_stall) begin
+			end
+
+			/* Shift in progress: keep the instruction. */
+			else if (shift_wait) begin
+				shift_started <= 1'b1;
+			end
+
+`ifndef ENABLE_DUAL_PORT_RAM
+			/*
+			 * Load/store: memory busy with data, the next instruction
+			 * (already at fetch_pc) will be fetched in the next clock.
+			 */
+			else if (is_mem) begin
+				ex_valid <= 1'b0;
+				if (insntype_o == `INSN_MEM_LW) begin
+					load_pending <= 1'b1;
+					load_reg     <= regdst_o;
+				end
+			end
+`else
+			/* Store over the fetched instruction: fetch it again. */
+			else if (store_hit) begin
+				ex_valid <= 1'b0;
+			end
+`endif
+
+			/* Taken branch: squash PC+1 and fetch the target. */
+			else if (is_taken) begin
+				ex_valid      <= 1'b0;
+				shift_started <= 1'b0;
+
+				if (nextpc_o == `INSN_PC_IMM)
+					fetch_pc <= PCplus_imm;
+				else
+					fetch_pc <= reg_data1[`RAM_SIZE_LOG-1:0];
+			end
+
+			/* Normal execution: next instruction already fetched. */
+			else begin
+				pc            <= fetch_pc;
+				fetch_pc      <= fetch_pc + 1'd1;
+				shift_started <= 1'b0;
+`ifdef ENABLE_DUAL_PORT_RAM
+				if (insntype_o == `INSN_MEM_LW) begin
+					load_pending <= 1'b1;
+					load_reg     <= regdst_o;
+				end
+`endif
+			end
+		end
+	end
+endmodule
+`endif
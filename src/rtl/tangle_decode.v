@@ -81,7 +81,8 @@
  *
  * Clock notes:
  * ------------
- * AMI instructions takes 3 clock cycles to finish.
+ * AMI instructions takes 3 clock cycles to finish (2 with
+ * ENABLE_REGFILE_BYPASS).
  *
  *
  * Branch/Jump
@@ -116,7 +117,12 @@
  * Clock notes:
  * ------------
  * Taken jumps: 4 cycles
- * Not taken jumps: 3 cycles
+ * Not taken jumps: 3 cycles (2 with ENABLE_REGFILE_BYPASS)
+ *
+ * With ENABLE_BRANCH_PREDICTION (FSM CPU), immediate J/JAL and backward
+ * branches are predicted as taken:
+ * - Immediate J/JAL and taken backward branches: 3 cycles
+ * - Not taken backward branches: 4 cycles
  *
  *
  * Memory (Load/Store)
@@ -147,7 +153,7 @@
  *
  * Clock notes:
  * ------------
- * Load: 4 cycles
+ * Load: 4 cycles (3 with ENABLE_REGFILE_BYPASS)
  * Store: 3 cycles
  *
  *
@@ -337,10 +343,10 @@ module testbench_decode;
 	wire regwe_o;
 	wire memwe_o;
 
-	initial  begin
-		$dumpfile("decode.vcd");
-		$dumpvars;
-	end
+	/* Waveform dump, see tangle_dump.vh. */
+`define DUMP_NAME  "decode"
+`define DUMP_SCOPE testbench_decode
+`include "tangle_dump.vh"
 
 	decode decode_unit(
 		.insn_i(insn_i),
@@ -0,0 +1,83 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Davidson Francis <davidsondfgl@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Testbench waveform dump.
+ *
+ * Included (inside the module) by every testbench, instead of a
+ * plain '$dumpfile' + '$dumpvars', after defining DUMP_NAME (the
+ * default file name, w/o extension) and DUMP_SCOPE (the testbench
+ * module). The dump is selected with plusargs ('make run' sets them
+ * from DUMP, DUMPDEPTH...):
+ *   +dump=<off|vcd|fst>  Dump format, or none (default: vcd). FST also
+ *                        needs the '-fst' vvp flag.
+ *   +dumpfile=<file>     Output file (default: DUMP_NAME.<format>).
+ *   +dumpdepth=<levels>  Hierarchy levels below DUMP_SCOPE (default:
+ *                        0, i.e: all).
+ *   +dumpfrom=<cycle>    First cycle dumped (default: 0).
+ *   +dumpto=<cycle>      Last cycle dumped (default: up to the end).
+ *
+ * Nothing is dumped before +dumpfrom (not even value changes are
+ * tracked), so that the simulation runs at full speed until there.
+ */
+
+/* Clock period, in time units, of all the testbenches. */
+`ifndef DUMP_PERIOD
+`define DUMP_PERIOD 10
+`endif
+
+	reg [8*256-1:0] dump_file;
+	reg [8*8-1:0]   dump_mode;
+	integer dump_depth;
+	integer dump_from;
+	integer dump_to;
+
+	initial begin
+		if (!$value$plusargs("dump=%s", dump_mode))
+			dump_mode = "vcd";
+		if (!$value$plusargs("dumpdepth=%d", dump_depth))
+			dump_depth = 0;
+		if (!$value$plusargs("dumpfrom=%d", dump_from))
+			dump_from = 0;
+		if (!$value$plusargs("dumpto=%d", dump_to))
+			dump_to = -1;
+
+		if (dump_mode != "off") begin
+			if (!$value$plusargs("dumpfile=%s", dump_file))
+				dump_file = {`DUMP_NAME, dump_mode == "fst" ? ".fst" : ".vcd"};
+			$dumpfile(dump_file);
+
+			if (dump_from > 0)
+				#(dump_from * `DUMP_PERIOD);
+			$dumpvars(dump_depth, `DUMP_SCOPE);
+
+			if (dump_to >= dump_from) begin
+				#((dump_to - dump_from + 1) * `DUMP_PERIOD);
+				$dumpoff;
+			end
+		end
+	end
+
+`undef DUMP_NAME
+`undef DUMP_SCOPE
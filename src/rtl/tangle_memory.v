@@ -31,7 +31,11 @@
  * otherwise, this will eats all the LUTs from your board.
  *
  * On Sipeed Tang Nano, it is possible to use up to 8kB (2 bytes * 2^12
- * elements, RAM_SIZE_LOG = 12).
+ * elements, RAM_SIZE_LOG = 12, the default), in which case the memory
+ * is banked across the 4 BSRAM blocks (1k x 16 each) by the synthesizer.
+ *
+ * The memory is initialized from 'ram.hex', or, in simulations built
+ * with 'ENABLE_RAM_PLUSARG', from the file given by '+ram=<file>'.
  */
 module memory
 	(
@@ -46,9 +50,19 @@ module memory
 	reg [`RAM_WIDTH-1:0] ram[(1 << `RAM_SIZE_LOG)-1:0];
 
 	/* Initial values. */
+`ifdef ENABLE_RAM_PLUSARG
+	reg [8*256-1:0] ram_file;
+
+	initial begin
+		if (!$value$plusargs("ram=%s", ram_file))
+			ram_file = "ram.hex";
+		$readmemh(ram_file, ram);
+	end
+`else
 	initial begin
 		$readmemh("ram.hex", ram);
 	end
+`endif
 
 	/* Output. */
 	always @ (posedge clk_i)
@@ -67,6 +81,68 @@ module memory
 endmodule
 
 
+/*
+ * Dual-port Memory Unit
+ *
+ * Same as above, but with a second, read-only, port, used to fetch
+ * instructions, while the other port is used for loads and stores.
+ * This maps to the Gowin BSRAM in (true) dual-port mode.
+ *
+ * Note: If both ports access the same address at the same clock,
+ * and the data port writes it, the fetch port reads the old value.
+ */
+module memory_dual
+	(
+		input clk_i,
+		input [`RAM_WIDTH-1:0] data_i,
+		input [`RAM_SIZE_LOG-1:0] addr_i,
+		input we_i,
+		output reg [`RAM_WIDTH-1:0] data_o,
+		input [`RAM_SIZE_LOG-1:0] fetch_addr_i,
+		output reg [`RAM_WIDTH-1:0] fetch_data_o
+	);
+
+	/* RAM memory. */
+	reg [`RAM_WIDTH-1:0] ram[(1 << `RAM_SIZE_LOG)-1:0];
+
+	/* Initial values. */
+`ifdef ENABLE_RAM_PLUSARG
+	reg [8*256-1:0] ram_file;
+
+	initial begin
+		if (!$value$plusargs("ram=%s", ram_file))
+			ram_file = "ram.hex";
+		$readmemh(ram_file, ram);
+	end
+`else
+	initial begin
+		$readmemh("ram.hex", ram);
+	end
+`endif
+
+	/* Data port. */
+	always @ (posedge clk_i)
+	begin
+		if (we_i)
+		begin
+			ram[addr_i] <= data_i;
+			data_o <= data_i;
+		end
+		else
+		begin
+			data_o <= ram[addr_i];
+		end
+	end
+
+	/* Fetch port. */
+	always @ (posedge clk_i)
+	begin
+		fetch_data_o <= ram[fetch_addr_i];
+	end
+
+endmodule
+
+
 /* Memory testbench, define 'ENABLE_TESTBENCHS' in order to test this unit. */
 `ifdef ENABLE_TESTBENCHS
 module testbench_memory;
@@ -76,10 +152,10 @@ module testbench_memory;
 	reg  [`RAM_SIZE_LOG-1:0] addr_i;
 	reg  we_i;
 
-	initial  begin
-		$dumpfile("ram.vcd");
-		$dumpvars;
-	end
+	/* Waveform dump, see tangle_dump.vh. */
+`define DUMP_NAME  "ram"
+`define DUMP_SCOPE testbench_memory
+`include "tangle_dump.vh"
 
 	memory memory_ram(
 		.clk_i(clk_i),
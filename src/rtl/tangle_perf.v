@@ -0,0 +1,94 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Davidson Francis <davidsondfgl@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+`include "tangle_config.v"
+
+/*
+ * Performance counters
+ *
+ * Four 32-bit counters, cleared on reset:
+ * - Cycles: every clock.
+ * - Retired instructions.
+ * - Memory stalls: clocks waiting for the memory, i.e: STATE_WAIT_MEM
+ *   in the FSM CPU, fetch bubbles and load write backs in the pipeline.
+ * - ALU stalls: clocks waiting for the shifter, i.e: STATE_WAIT_ALU
+ *   in the FSM CPU.
+ *
+ * The CPU maps them (read-only) at PERF_BASE, see tangle_config.v,
+ * where @p sel_i selects the word: counter (sel_i[2:1]) and half
+ * (sel_i[0], low word first).
+ *
+ * Note: The two halves are read by two different loads, so, in order
+ * to get a consistent value, read high, low and high again, and retry
+ * if the high words differ.
+ */
+module perf
+	(
+		input clk_i,
+		input rst_i,
+		input retire_i,
+		input mem_stall_i,
+		input alu_stall_i,
+		input  [2:0]  sel_i,
+		output [15:0] data_o
+	);
+
+	reg [31:0] cycles;
+	reg [31:0] retired;
+	reg [31:0] mem_stalls;
+	reg [31:0] alu_stalls;
+	reg [31:0] counter;
+
+	always @(posedge clk_i, `RESET_EDGE rst_i)
+	begin
+		if (`IS_RESET(rst_i)) begin
+			cycles     <= 32'h0;
+			retired    <= 32'h0;
+			mem_stalls <= 32'h0;
+			alu_stalls <= 32'h0;
+		end else begin
+			cycles <= cycles + 1'b1;
+			if (retire_i)
+				retired <= retired + 1'b1;
+			if (mem_stall_i)
+				mem_stalls <= mem_stalls + 1'b1;
+			if (alu_stall_i)
+				alu_stalls <= alu_stalls + 1'b1;
+		end
+	end
+
+	/* Word select. */
+	always @(*)
+	begin
+		case (sel_i[2:1])
+			`PERF_CYCLES:     counter = cycles;
+			`PERF_RETIRED:    counter = retired;
+			`PERF_MEM_STALLS: counter = mem_stalls;
+			default:          counter = alu_stalls;
+		endcase
+	end
+
+	assign data_o = sel_i[0] ? counter[31:16] : counter[15:0];
+
+endmodule
@@ -30,8 +30,26 @@
  * amount of registers from the board. The benefits of using this approach
  * is that a clock pulse is only required for writings, not readings!,
  * meaning the reads may happen at any time.
+ *
+ * Options (see tangle_config.v):
+ * - ENABLE_REGFILE_BYPASS: adds a second write port (reg3_i/data3_i),
+ *   used by the load write back, with a write-first bypass: reading
+ *   the register being written by it returns the new value in the
+ *   same clock. The first port (reg1_i/data_i) has priority if both
+ *   write the same register.
+ *
+ * - ENABLE_REGFILE_SSRAM: maps the registers into distributed RAM
+ *   (SSRAM) instead of flip-flops. The RAM cannot be reset, so the
+ *   registers are only cleared in the configuration.
+ *
+ * @p R1_RESET and @p R2_RESET are the r1 and r2 values after reset,
+ * i.e: the core ID and count, in the multi-core SoC.
  */
 module register_file
+	#(
+		parameter R1_RESET = 16'd0,
+		parameter R2_RESET = 16'd0
+	)
 	(
 		input clk_i,
 		input rst_i,
@@ -39,6 +57,11 @@ module register_file
 		input  [2:0]  reg1_i,
 		input  [2:0]  reg2_i,
 		input  [15:0] data_i,
+`ifdef ENABLE_REGFILE_BYPASS
+		input  we2_i,
+		input  [2:0]  reg3_i,
+		input  [15:0] data3_i,
+`endif
 		output [15:0] data1_o,
 		output [15:0] data2_o
 	);
@@ -49,8 +72,32 @@ module register_file
 	 * Note: Seems that Gowin is not inferring BRAM here.
 	 * If things get tight, it might be worth it to
 	 * 'waste memory' and (try to) 'force' an inference to
-	 * BRAM here.
+	 * BRAM here, or to distributed RAM, with
+	 * ENABLE_REGFILE_SSRAM.
 	 */
+`ifdef ENABLE_REGFILE_SSRAM
+	(* ram_style = "distributed" *)
+	reg [15:0] registers[0:7] /* synthesis syn_ramstyle = "distributed_ram" */;
+
+	integer i;
+	initial begin
+		for (i = 0; i < 8; i = i + 1)
+			registers[i] = 16'd0;
+		registers[1] = R1_RESET;
+		registers[2] = R2_RESET;
+	end
+
+	/* Write only, no reset. */
+	always @(posedge clk_i)
+	begin
+		if (we_i) begin
+			/* Prohibits writings in r0. */
+			if (reg1_i != 0) begin
+				registers[reg1_i] <= data_i;
+			end
+		end
+	end
+`else
 	reg [15:0] registers[0:7];
 
 	/* Write and/or reset. */
@@ -58,8 +105,8 @@ module register_file
 	begin
 		if (`IS_RESET(rst_i)) begin
 			registers[0] <= 16'd0;
-			registers[1] <= 16'd0;
-			registers[2] <= 16'd0;
+			registers[1] <= R1_RESET;
+			registers[2] <= R2_RESET;
 			registers[3] <= 16'd0;
 			registers[4] <= 16'd0;
 			registers[5] <= 16'd0;
@@ -67,6 +114,14 @@ module register_file
 			registers[7] <= 16'd0;
 		end
 		else begin
+`ifdef ENABLE_REGFILE_BYPASS
+			/* Second port, overridden by the first one. */
+			if (we2_i) begin
+				if (reg3_i != 0) begin
+					registers[reg3_i] <= data3_i;
+				end
+			end
+`endif
 			/* Writes available 1-clock later. */
 			if (we_i) begin
 				/* Prohibits writings in r0. */
@@ -76,14 +131,30 @@ module register_file
 			end
 		end
 	end
+`endif
 
 	/*
 	 * Reads available immediately.
 	 * It also saves us a few valuable registers, this
 	 * resource is limited too =).
+	 *
+	 * With the bypass, the second write port data is
+	 * forwarded (write-first) to the reads, so it is
+	 * available in the same clock, not only in the next.
+	 * The first port is never forwarded: its address is
+	 * also the first read address, and its data usually
+	 * comes from the ALU, i.e: would create a loop.
 	 */
+`ifdef ENABLE_REGFILE_BYPASS
+	wire bypass1 = we2_i && reg3_i != 0 && reg3_i == reg1_i;
+	wire bypass2 = we2_i && reg3_i != 0 && reg3_i == reg2_i;
+
+	assign data1_o = bypass1 ? data3_i : registers[reg1_i];
+	assign data2_o = bypass2 ? data3_i : registers[reg2_i];
+`else
 	assign data1_o = registers[reg1_i];
 	assign data2_o = registers[reg2_i];
+`endif
 
 endmodule
 
@@ -103,10 +174,10 @@ module testbench_register_file;
 	wire [15:0] data1_o;
 	wire [15:0] data2_o;
 
-	initial  begin
-		$dumpfile("register_file.vcd");
-		$dumpvars;
-	end
+	/* Waveform dump, see tangle_dump.vh. */
+`define DUMP_NAME  "register_file"
+`define DUMP_SCOPE testbench_register_file
+`include "tangle_dump.vh"
 
 	register_file register_file_unit(
 		.clk_i(clk_i),
@@ -115,6 +186,11 @@ module testbench_register_file;
 		.reg1_i(reg1_i),
 		.reg2_i(reg2_i),
 		.data_i(data_i),
+`ifdef ENABLE_REGFILE_BYPASS
+		.we2_i(1'b0),
+		.reg3_i(3'd0),
+		.data3_i(16'h0),
+`endif
 		.data1_o(data1_o),
 		.data2_o(data2_o)
 	);
@@ -28,12 +28,17 @@
  * Tangle SoC
  *
  * This module brings together all the components and is
- * expected to be the "TOP" module.
+ * expected to be the "TOP" module, unless the board layer adds
+ * one (e.g: a PLL), which then sets @p CLK_FREQ, in Hz.
  */
 module tangle_soc
+	#(
+		parameter CLK_FREQ = `CLK_FREQ
+	)
 	(
 		input clk_i,
 		input rst_i,
+		input uart_rx_i,
 		output led1,
 		output led2,
 		output led3
@@ -45,23 +50,157 @@ module tangle_soc
 	wire mem_we;
 	wire f1, f2, f3;
 
+	/* Memory (data port) and CPU reset, shared with the loader. */
+	wire [15:0] ram_data_i;
+	wire [15:0] ram_addr_i;
+	wire ram_we;
+	wire cpu_rst;
+
+`ifdef ENABLE_UART_LOADER
+	/*
+	 * UART loader, see tangle_config.v: from the sync byte on, the
+	 * CPU is held in reset and the loader owns the memory port,
+	 * until the last word gets written.
+	 */
+	localparam LD_IDLE    = 3'd0;
+	localparam LD_CNT_LO  = 3'd1;
+	localparam LD_CNT_HI  = 3'd2;
+	localparam LD_DATA_LO = 3'd3;
+	localparam LD_DATA_HI = 3'd4;
+
+	wire [7:0] rx_data;
+	wire rx_valid;
+
+	reg [2:0]  ld_state;
+	reg [15:0] ld_count;
+	reg [15:0] ld_addr;
+	reg [15:0] ld_data;
+	reg ld_we;
+	reg ld_busy; /* Loader owns the memory. */
+
+	uart_rx #(
+		.CLKS_PER_BIT(CLK_FREQ / `UART_BAUD)
+	) uart_unit(
+		.clk_i(clk_i),
+		.rst_i(rst_i),
+		.rx_i(uart_rx_i),
+		.data_o(rx_data),
+		.valid_o(rx_valid)
+	);
+
+	always @(posedge clk_i, `RESET_EDGE rst_i)
+	begin
+		if (`IS_RESET(rst_i)) begin
+			ld_state <= LD_IDLE;
+			ld_count <= 16'h0;
+			ld_addr  <= 16'h0;
+			ld_data  <= 16'h0;
+			ld_we    <= 1'b0;
+			ld_busy  <= 1'b0;
+		end else begin
+			/* Write, one clock, and advance. */
+			ld_we <= 1'b0;
+			if (ld_we) begin
+				ld_addr <= ld_addr + 1'b1;
+				if (ld_state == LD_IDLE)
+					ld_busy <= 1'b0;
+			end
+
+			if (rx_valid) begin
+				case (ld_state)
+					LD_IDLE: begin
+						if (rx_data == `LOADER_SYNC) begin
+							ld_busy  <= 1'b1;
+							ld_state <= LD_CNT_LO;
+						end
+					end
+					LD_CNT_LO: begin
+						ld_count[7:0] <= rx_data;
+						ld_state      <= LD_CNT_HI;
+					end
+					LD_CNT_HI: begin
+						ld_count[15:8] <= rx_data;
+						ld_addr        <= 16'h0;
+						if ({rx_data, ld_count[7:0]} == 16'h0) begin
+							ld_busy  <= 1'b0;
+							ld_state <= LD_IDLE;
+						end else
+							ld_state <= LD_DATA_LO;
+					end
+					LD_DATA_LO: begin
+						ld_data[7:0] <= rx_data;
+						ld_state     <= LD_DATA_HI;
+					end
+					LD_DATA_HI: begin
+						ld_data[15:8] <= rx_data;
+						ld_we         <= 1'b1;
+						ld_count      <= ld_count - 1'b1;
+						ld_state      <= (ld_count == 16'h1) ?
+							LD_IDLE : LD_DATA_LO;
+					end
+					default:
+						ld_state <= LD_IDLE;
+				endcase
+			end
+		end
+	end
+
+`else
+	wire [15:0] ld_addr = 16'h0;
+	wire [15:0] ld_data = 16'h0;
+	wire ld_we   = 1'b0;
+	wire ld_busy = 1'b0;
+`endif
+
+	assign ram_data_i = ld_busy ? ld_data : mem_data_i;
+	assign ram_addr_i = ld_busy ? ld_addr : mem_addr_i;
+	assign ram_we     = ld_busy ? ld_we   : mem_we;
+	assign cpu_rst    = ld_busy ? `RESET_LEVEL : rst_i;
+
+`ifdef ENABLE_DUAL_PORT_RAM
+	wire [15:0] fetch_addr_i;
+	wire [15:0] fetch_data_o;
+
+	/* Memory, data + fetch ports. */
+	memory_dual memory_unit(
+		.clk_i(clk_i),
+		.data_i(ram_data_i),
+		.addr_i(ram_addr_i[`RAM_SIZE_LOG-1:0]),
+		.we_i(ram_we),
+		.data_o(mem_data_o),
+		.fetch_addr_i(fetch_addr_i[`RAM_SIZE_LOG-1:0]),
+		.fetch_data_o(fetch_data_o)
+	);
+`else
 	/* Memory. */
 	memory memory_unit(
 		.clk_i(clk_i),
-		.data_i(mem_data_i),
-		.addr_i(mem_addr_i[`RAM_SIZE_LOG-1:0]),
-		.we_i(mem_we),
+		.data_i(ram_data_i),
+		.addr_i(ram_addr_i[`RAM_SIZE_LOG-1:0]),
+		.we_i(ram_we),
 		.data_o(mem_data_o)
 	);
+`endif
 
-	/* CPU. */
-	cpu cpu_unit(
+	/* CPU, core 0. */
+	cpu
+`ifdef ENABLE_MULTICORE
+	#(
+		.CORE_ID(0),
+		.NCORES(`NCORES)
+	)
+`endif
+	cpu_unit(
 		.clk_i(clk_i),
-		.rst_i(rst_i),
+		.rst_i(cpu_rst),
 		.mem_data_o(mem_data_o),
 		.mem_addr_i(mem_addr_i),
 		.mem_data_i(mem_data_i),
 		.mem_we(mem_we),
+`ifdef ENABLE_DUAL_PORT_RAM
+		.fetch_data_o(fetch_data_o),
+		.fetch_addr_i(fetch_addr_i),
+`endif
 		.dbg_zf(f1),
 		.dbg_sf(f2),
 		.dbg_cf(f3)
@@ -71,6 +210,68 @@ module tangle_soc
 	assign led2 = !f2;
 	assign led3 = !f3;
 
+`ifdef ENABLE_MULTICORE
+	/*
+	 * Cores 1 to NCORES-1: as core 0 (above), each one with its own
+	 * memory bank, written by the loader as well.
+	 */
+	genvar core;
+	generate
+		for (core = 1; core < `NCORES; core = core + 1) begin : cores
+			wire [15:0] c_mem_data_i;
+			wire [15:0] c_mem_addr_i;
+			wire [15:0] c_mem_data_o;
+			wire c_mem_we;
+
+			wire [15:0] c_ram_data_i = ld_busy ? ld_data : c_mem_data_i;
+			wire [15:0] c_ram_addr_i = ld_busy ? ld_addr : c_mem_addr_i;
+			wire c_ram_we            = ld_busy ? ld_we   : c_mem_we;
+
+`ifdef ENABLE_DUAL_PORT_RAM
+			wire [15:0] c_fetch_addr_i;
+			wire [15:0] c_fetch_data_o;
+
+			memory_dual memory_unit(
+				.clk_i(clk_i),
+				.data_i(c_ram_data_i),
+				.addr_i(c_ram_addr_i[`RAM_SIZE_LOG-1:0]),
+				.we_i(c_ram_we),
+				.data_o(c_mem_data_o),
+				.fetch_addr_i(c_fetch_addr_i[`RAM_SIZE_LOG-1:0]),
+				.fetch_data_o(c_fetch_data_o)
+			);
+`else
+			memory memory_unit(
+				.clk_i(clk_i),
+				.data_i(c_ram_data_i),
+				.addr_i(c_ram_addr_i[`RAM_SIZE_LOG-1:0]),
+				.we_i(c_ram_we),
+				.data_o(c_mem_data_o)
+			);
+`endif
+
+			cpu #(
+				.CORE_ID(core),
+				.NCORES(`NCORES)
+			) cpu_unit(
+				.clk_i(clk_i),
+				.rst_i(cpu_rst),
+				.mem_data_o(c_mem_data_o),
+				.mem_addr_i(c_mem_addr_i),
+				.mem_data_i(c_mem_data_i),
+				.mem_we(c_mem_we),
+`ifdef ENABLE_DUAL_PORT_RAM
+				.fetch_data_o(c_fetch_data_o),
+				.fetch_addr_i(c_fetch_addr_i),
+`endif
+				.dbg_zf(),
+				.dbg_sf(),
+				.dbg_cf()
+			);
+		end
+	endgenerate
+`endif
+
 endmodule
 
 
@@ -80,6 +281,7 @@ module testbench_soc;
 
 	reg  clk_i;
 	reg  rst_i;
+	reg  uart_rx_i;
 	wire led1;
 	wire led2;
 	wire led3;
@@ -87,27 +289,126 @@ module testbench_soc;
 	tangle_soc soc_unit(
 		.clk_i(clk_i),
 		.rst_i(rst_i),
+		.uart_rx_i(uart_rx_i),
 		.led1(led1),
 		.led2(led2),
 		.led3(led3)
 	);
 
-	initial begin
-		$dumpfile("soc.vcd");
-		$dumpvars;
-	end
+	/* Waveform dump, see tangle_dump.vh. */
+`define DUMP_NAME  "soc"
+`define DUMP_SCOPE testbench_soc
+`include "tangle_dump.vh"
 
 	initial begin
-			clk_i = 1'b0;
-			rst_i = 1'b1;
+			clk_i     = 1'b0;
+			rst_i     = 1'b1;
+			uart_rx_i = 1'b1;
 		#5 	rst_i = 1'b0;
 	end
 
 	always
 		#5 clk_i = !clk_i;
 
-	initial
-		#3500 $finish;
+	/*
+	 * PC profile: with '+profile=<file>', the PC is sampled every
+	 * clock and the cycles spent at each PC are dumped into <file>
+	 * at the end, in the same format as the ISS (-g), for the
+	 * profiler (toolchain/prof).
+	 */
+	integer prof_fd;
+	integer prof_i;
+	integer prof_cycles [0:(1 << `RAM_SIZE_LOG)-1];
+	reg [8*256-1:0] prof_file;
+
+	initial begin
+		prof_fd = 0;
+		for (prof_i = 0; prof_i < (1 << `RAM_SIZE_LOG); prof_i = prof_i + 1)
+			prof_cycles[prof_i] = 0;
+		if ($value$plusargs("profile=%s", prof_file))
+			prof_fd = $fopen(prof_file, "w");
+	end
+
+	always @(posedge clk_i)
+		if (prof_fd && !rst_i)
+			prof_cycles[soc_unit.cpu_unit.pc] <=
+				prof_cycles[soc_unit.cpu_unit.pc] + 1;
+
+	task dump_profile;
+		begin
+			for (prof_i = 0; prof_i < (1 << `RAM_SIZE_LOG); prof_i = prof_i + 1)
+				if (prof_cycles[prof_i])
+					$fwrite(prof_fd, "%h %0d\n", prof_i[15:0], prof_cycles[prof_i]);
+			$fclose(prof_fd);
+		end
+	endtask
+
+	/*
+	 * Run length and triggers:
+	 *   +cycles=<n>   Stops after <n> cycles (default: 350).
+	 *   +trigger=<pc> Stops when the PC (hex) is reached.
+	 *   +halt         Stops when the CPU halts (jumps to itself), i.e:
+	 *                 the PC stays the same for HALT_CYCLES cycles.
+	 * The stop reason and cycle are always reported, so that a second
+	 * run may dump only the cycles before a trigger (+dumpfrom, see
+	 * 'make run DUMPWINDOW=<n>').
+	 */
+	localparam HALT_CYCLES = 16;
+
+	integer run_cycles;
+	integer same_pc;
+	reg [15:0] trigger_pc;
+	reg [`RAM_SIZE_LOG-1:0] last_pc;
+	reg has_trigger;
+	reg stop_halt;
+
+	task stop;
+		input [8*16-1:0] reason;
+		begin
+			$display("Stopped: %0s, PC: 0x%h, cycle %0d", reason,
+				soc_unit.cpu_unit.pc, $time / `DUMP_PERIOD);
+`ifdef ENABLE_PERF_COUNTERS
+			$display("cycles: %0d, retired: %0d, mem stalls: %0d, alu stalls: %0d",
+				soc_unit.cpu_unit.perf_unit.cycles,
+				soc_unit.cpu_unit.perf_unit.retired,
+				soc_unit.cpu_unit.perf_unit.mem_stalls,
+				soc_unit.cpu_unit.perf_unit.alu_stalls);
+`endif
+			if (prof_fd)
+				dump_profile;
+			$finish;
+		end
+	endtask
+
+	initial begin
+		if (!$value$plusargs("cycles=%d", run_cycles))
+			run_cycles = 350;
+		has_trigger = $value$plusargs("trigger=%h", trigger_pc);
+		stop_halt   = $test$plusargs("halt");
+		same_pc     = 0;
+		last_pc     = 0;
+
+		#(run_cycles * `DUMP_PERIOD);
+		stop("cycle limit");
+	end
+
+	always @(posedge clk_i) begin
+		if (!rst_i) begin
+			if (has_trigger && soc_unit.cpu_unit.pc == trigger_pc[`RAM_SIZE_LOG-1:0])
+				stop("trigger");
+
+			if (soc_unit.cpu_unit.pc != last_pc) begin
+				last_pc <= soc_unit.cpu_unit.pc;
+				same_pc <= 0;
+			end
+			else if (same_pc == HALT_CYCLES - 1) begin
+				if (stop_halt)
+					stop("halt");
+			end
+			else
+				same_pc <= same_pc + 1;
+		end
+	end
 
 endmodule
 `endif
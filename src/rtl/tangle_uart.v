@@ -0,0 +1,111 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Davidson Francis <davidsondfgl@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+`include "tangle_config.v"
+
+/*
+ * UART receiver
+ *
+ * 8N1, LSB first, at UART_BAUD: the start bit is validated at its
+ * middle and the data/stop bits are sampled at theirs. @p valid_o
+ * pulses for a clock when a byte, with a valid stop bit, is in
+ * @p data_o.
+ */
+module uart_rx
+	#(
+		parameter CLKS_PER_BIT = `CLK_FREQ / `UART_BAUD
+	)
+	(
+		input clk_i,
+		input rst_i,
+		input rx_i,
+		output reg [7:0] data_o,
+		output reg valid_o
+	);
+
+	localparam RX_IDLE  = 2'd0;
+	localparam RX_START = 2'd1;
+	localparam RX_DATA  = 2'd2;
+	localparam RX_STOP  = 2'd3;
+
+	reg [1:0]  state;
+	reg [1:0]  rx_sync; /* Synchronizer, rx_i is asynchronous. */
+	reg [15:0] clk_cnt;
+	reg [2:0]  bit_idx;
+
+	wire rx       = rx_sync[1];
+	wire bit_end  = (clk_cnt == CLKS_PER_BIT - 1);
+	wire half_bit = (clk_cnt == (CLKS_PER_BIT - 1) / 2);
+
+	always @(posedge clk_i, `RESET_EDGE rst_i)
+	begin
+		if (`IS_RESET(rst_i)) begin
+			state   <= RX_IDLE;
+			rx_sync <= 2'b11;
+			clk_cnt <= 16'h0;
+			bit_idx <= 3'h0;
+			data_o  <= 8'h0;
+			valid_o <= 1'b0;
+		end else begin
+			rx_sync <= {rx_sync[0], rx_i};
+			valid_o <= 1'b0;
+			clk_cnt <= clk_cnt + 1'b1;
+
+			case (state)
+				RX_IDLE: begin
+					clk_cnt <= 16'h0;
+					if (!rx)
+						state <= RX_START;
+				end
+
+				/* Start bit, still low at its middle? */
+				RX_START: begin
+					if (half_bit) begin
+						clk_cnt <= 16'h0;
+						bit_idx <= 3'h0;
+						state   <= rx ? RX_IDLE : RX_DATA;
+					end
+				end
+
+				RX_DATA: begin
+					if (bit_end) begin
+						clk_cnt <= 16'h0;
+						data_o  <= {rx, data_o[7:1]};
+						bit_idx <= bit_idx + 1'b1;
+						if (bit_idx == 3'd7)
+							state <= RX_STOP;
+					end
+				end
+
+				RX_STOP: begin
+					if (bit_end) begin
+						valid_o <= rx;
+						state   <= RX_IDLE;
+					end
+				end
+			endcase
+		end
+	end
+
+endmodule
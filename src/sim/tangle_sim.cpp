@@ -0,0 +1,401 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Davidson Francis <davidsondfgl@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Tangle SoC Verilator harness.
+ *
+ * Runs the Verilated 'tangle_soc' (see the 'verilate' rule in
+ * src/Makefile) with a RAM image given in the command line, until
+ * the CPU halts (i.e: jumps to itself), reaches an exit PC or the
+ * cycle budget runs out, and then dumps the CPU state, in the
+ * same format as the ISS (src/toolchain/iss).
+ *
+ * If the SoC is built with ENABLE_PERF_COUNTERS (in SIMFLAGS), the
+ * performance counters are dumped as well.
+ *
+ * With '-g', the PC is sampled every clock and the cycles spent at
+ * each PC are dumped at the end, in the same format as the ISS, for
+ * the profiler (toolchain/prof).
+ *
+ * When built with VCD=1, the waveform can be dumped with '-v'.
+ *
+ * With '-t', a single summary line is printed instead, in the same
+ * format as the ISS '-t' (see 'make bench BENCHSIM=verilator'): the
+ * cycles exclude the halt detection (HALT_CYCLES) and the executed
+ * instructions are only known with ENABLE_PERF_COUNTERS (0 otherwise).
+ */
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <getopt.h>
+
+#include <verilated.h>
+#if VM_TRACE
+#include <verilated_vcd_c.h>
+#endif
+
+#include "Vtangle_soc.h"
+#include "Vtangle_soc___024root.h"
+
+/* Public signals, see tangle_sim.vlt. */
+#define CPU_PC(t) \
+	((t)->rootp->tangle_soc__DOT__cpu_unit__DOT__pc)
+#define CPU_REG(t, r) \
+	((t)->rootp->tangle_soc__DOT__cpu_unit__DOT__register_file_unit__DOT__registers[(r)])
+#define CPU_PERF(t, c) \
+	((t)->rootp->tangle_soc__DOT__cpu_unit__DOT__perf_unit__DOT__ ## c)
+
+/*
+ * Cycles with the same PC to consider the CPU halted: more than
+ * the slowest instruction (a 15-bit iterative shift) takes.
+ */
+#define HALT_CYCLES 16
+
+/* Exit reasons. */
+#define EXIT_HALT   0 /* Jump to itself.    */
+#define EXIT_PC     1 /* Exit PC reached.   */
+#define EXIT_CYCLES 2 /* Cycle limit hit.   */
+
+/* Options. */
+static const char *ram_file = "ram.hex";
+static const char *vcd_file;
+static const char *prof_file;
+static uint64_t max_cycles = 10000000;
+static long exit_pc = -1;
+static int quiet;
+static int summary;
+
+#if VM_TRACE
+static VerilatedVcdC *tfp;
+#endif
+
+/**
+ * Advances the simulation half a clock, dumping the
+ * waveform, if enabled.
+ *
+ * @param ctx Verilator context.
+ * @param top SoC model.
+ * @param clk Clock level.
+ */
+static void half_cycle(VerilatedContext *ctx, Vtangle_soc *top, int clk)
+{
+	top->clk_i = clk;
+	top->eval();
+#if VM_TRACE
+	if (tfp)
+		tfp->dump(ctx->time());
+#endif
+	ctx->timeInc(5);
+}
+
+/**
+ * Shows the usage.
+ *
+ * @param prgname Program name.
+ */
+static void usage(const char *prgname)
+{
+	fprintf(stderr, "Usage: %s [options] [ram.hex]\n", prgname);
+	fprintf(stderr, "Options: \n");
+	fprintf(stderr, "   -c <cycles> Cycle budget (default: %" PRIu64
+		", 0 = unlimited)\n", max_cycles);
+	fprintf(stderr, "   -e <pc> Stop when reaching <pc>\n");
+	fprintf(stderr, "   -g <file> Dump the PC profile (cycles per PC) at "
+		"exit\n");
+#if VM_TRACE
+	fprintf(stderr, "   -v <file> Dump the waveform (VCD) to <file>\n");
+#endif
+	fprintf(stderr, "   -q Quiet, do not print the final state\n");
+	fprintf(stderr, "   -t Print a single summary line (as the ISS -t), "
+		"instead\n\n");
+	fprintf(stderr, "The simulation always stops in a jump to "
+		"itself (halt)\n");
+	exit(EXIT_FAILURE);
+}
+
+/**
+ * Parses the command-line arguments.
+ *
+ * @param argc Argument count.
+ * @param argv Argument list.
+ */
+static void parse_args(int argc, char **argv)
+{
+	char *end;
+	int c;
+
+	while ((c = getopt(argc, argv, "hqtc:e:g:v:")) != -1)
+	{
+		switch (c)
+		{
+			case 'c':
+				max_cycles = strtoull(optarg, &end, 0);
+				if (end == optarg || *end)
+					usage(argv[0]);
+				break;
+			case 'e':
+				exit_pc = strtol(optarg, &end, 0);
+				if (end == optarg || *end || exit_pc < 0)
+					usage(argv[0]);
+				break;
+			case 'g':
+				prof_file = optarg;
+				break;
+			case 'q':
+				quiet = 1;
+				break;
+			case 't':
+				summary = 1;
+				break;
+#if VM_TRACE
+			case 'v':
+				vcd_file = optarg;
+				break;
+#endif
+			default:
+				usage(argv[0]);
+				break;
+		}
+	}
+
+	if (optind < argc)
+		ram_file = argv[optind];
+}
+
+/**
+ * Dumps the PC profile @p prof: one '<pc> <cycles>' line (hex
+ * and decimal) per PC with cycles.
+ *
+ * @param prof Cycles per PC.
+ *
+ * @return Returns 1 if success, 0 otherwise.
+ */
+static int dump_prof(const std::vector<uint64_t> &prof)
+{
+	FILE *f;
+	int ret;
+
+	if (!strcmp(prof_file, "-"))
+		f = stdout;
+	else if (!(f = fopen(prof_file, "w")))
+	{
+		fprintf(stderr, "Unable to open %s\n", prof_file);
+		return (0);
+	}
+
+	for (size_t i = 0; i < prof.size(); i++)
+		if (prof[i])
+			fprintf(f, "%04zx %" PRIu64 "\n", i, prof[i]);
+
+	ret = !ferror(f);
+	if (f != stdout)
+		ret = !fclose(f) && ret;
+	if (!ret)
+		fprintf(stderr, "Unable to write %s\n", prof_file);
+	return (ret);
+}
+
+/**
+ * Prints the single line summary, as the ISS '-t' does.
+ *
+ * @param insns Executed instructions, 0 if unknown.
+ * @param cycles Elapsed cycles, w/o the halt detection.
+ * @param reason Exit reason.
+ * @param reasons Exit reasons descriptions.
+ * @param secs Host time, in seconds.
+ */
+static void print_summary(uint64_t insns, uint64_t cycles, int reason,
+	const char *const *reasons, double secs)
+{
+	const char *name; /* File name, w/o the path. */
+	const char *ext;  /* File extension.          */
+
+	name = strrchr(ram_file, '/');
+	name = name ? name + 1 : ram_file;
+	ext  = strrchr(name, '.');
+	if (!ext || ext == name)
+		ext = name + strlen(name);
+
+	printf("%-12.*s %10" PRIu64 " %10" PRIu64 " %6.2f %10.3f%s%s\n",
+		(int)(ext - name), name, insns, cycles,
+		insns ? (double)cycles / insns : 0.0,
+		secs * 1e3,
+		reason != EXIT_HALT ? "  " : "",
+		reason != EXIT_HALT ? reasons[reason] : "");
+}
+
+/**
+ * Main
+ */
+int main(int argc, char **argv)
+{
+	static const char *const reasons[] = {
+		"halt (jump to itself)",
+		"exit PC reached",
+		"cycle limit reached"
+	};
+	std::vector<uint64_t> prof; /* Cycles per PC.      */
+	VerilatedContext *ctx;      /* Verilator context.  */
+	Vtangle_soc *top;           /* SoC model.          */
+	std::string ram_arg;        /* +ram=<file>.        */
+	struct timespec start, end; /* Host time.          */
+	uint64_t insns;             /* Retired, till halt. */
+	const char *vargs[2];       /* Verilator args.     */
+	uint64_t cycles;            /* Elapsed cycles.     */
+	unsigned last_pc;           /* PC, last cycle.     */
+	unsigned same_pc;           /* Cycles w/ same PC.  */
+	int reason;                 /* Exit reason.        */
+	int ret;                    /* Return code.        */
+
+	parse_args(argc, argv);
+
+	/* The memory reads its image from '+ram=<file>'. */
+	ram_arg  = std::string("+ram=") + ram_file;
+	vargs[0] = argv[0];
+	vargs[1] = ram_arg.c_str();
+
+	ctx = new VerilatedContext;
+	ctx->commandArgs(2, vargs);
+	top = new Vtangle_soc{ctx};
+
+#if VM_TRACE
+	if (vcd_file)
+	{
+		ctx->traceEverOn(true);
+		tfp = new VerilatedVcdC;
+		top->trace(tfp, 99);
+		tfp->open(vcd_file);
+	}
+#endif
+
+	/* UART idle, reset, active low, as in the board. */
+	top->uart_rx_i = 1;
+	top->rst_i = 1;
+	half_cycle(ctx, top, 0);
+	top->rst_i = 0;
+	half_cycle(ctx, top, 1);
+	half_cycle(ctx, top, 0);
+	top->rst_i = 1;
+
+	reason  = EXIT_CYCLES;
+	last_pc = CPU_PC(top);
+	same_pc = 0;
+	insns   = 0;
+
+	/* The PC is 16-bit at most. */
+	if (prof_file)
+		prof.resize(1 << 16);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (cycles = 0; !max_cycles || cycles < max_cycles; cycles++)
+	{
+		/* Profile: the PC being executed in this clock. */
+		if (prof_file)
+			prof[CPU_PC(top)]++;
+
+		half_cycle(ctx, top, 1);
+		half_cycle(ctx, top, 0);
+
+		if (CPU_PC(top) == exit_pc)
+		{
+			reason = EXIT_PC;
+			break;
+		}
+
+		if (CPU_PC(top) != last_pc)
+		{
+			last_pc = CPU_PC(top);
+			same_pc = 0;
+#ifdef ENABLE_PERF_COUNTERS
+			/* Retired before the halt, plus the halting jump. */
+			insns = (uint64_t)CPU_PERF(top, retired) + 1;
+#endif
+		}
+		else if (++same_pc == HALT_CYCLES)
+		{
+			reason = EXIT_HALT;
+			break;
+		}
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	top->final();
+
+	/* Halt detection cycles. */
+	if (summary)
+	{
+		if (reason == EXIT_HALT)
+			cycles -= HALT_CYCLES;
+#ifdef ENABLE_PERF_COUNTERS
+		else
+			insns = (uint64_t)CPU_PERF(top, retired);
+#endif
+		print_summary(insns, cycles, reason, reasons,
+			(double)(end.tv_sec - start.tv_sec) +
+			(double)(end.tv_nsec - start.tv_nsec) * 1e-9);
+	}
+	else if (!quiet)
+	{
+		printf("Stopped: %s, PC: 0x%04x\n", reasons[reason],
+			(unsigned)CPU_PC(top));
+		printf("Cycles: %" PRIu64 "\n", cycles);
+#ifdef ENABLE_PERF_COUNTERS
+		printf("Perf counters: cycles: %u, retired: %u, mem stalls: %u, "
+			"alu stalls: %u\n",
+			(unsigned)CPU_PERF(top, cycles),
+			(unsigned)CPU_PERF(top, retired),
+			(unsigned)CPU_PERF(top, mem_stalls),
+			(unsigned)CPU_PERF(top, alu_stalls));
+#endif
+
+		for (int i = 0; i < 8; i++)
+			printf("r%d: 0x%04x%s", i, (unsigned)CPU_REG(top, i),
+				(i % 4) == 3 ? "\n" : "  ");
+
+		/* Flags LEDs are active low. */
+		printf("zf: %d  sf: %d  cf: %d\n", !top->led1, !top->led2,
+			!top->led3);
+	}
+
+#if VM_TRACE
+	if (tfp)
+	{
+		tfp->close();
+		delete tfp;
+	}
+#endif
+
+	ret = 1;
+	if (prof_file)
+		ret = dump_prof(prof);
+
+	delete top;
+	delete ctx;
+	return (ret ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,158 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Davidson Francis <davidsondfgl@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "arena.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * Rounds @p x up to the next ARENA_ALIGN multiple.
+ */
+#define ARENA_ROUND(x) (((x) + (ARENA_ALIGN - 1)) & ~((size_t)ARENA_ALIGN - 1))
+
+/**
+ * Chunk header size, already aligned, so the data that
+ * follows it is aligned too.
+ */
+#define ARENA_HDR_SIZE ARENA_ROUND(sizeof(struct arena_chunk))
+
+/**
+ * @brief Allocates a new chunk, with at least @p size bytes
+ * of data, and makes it the current one.
+ *
+ * @param a Arena structure.
+ * @param size Minimum data size.
+ *
+ * @return Returns 0 if success and a negative number
+ * otherwise.
+ */
+static int arena_grow(struct arena *a, size_t size)
+{
+	struct arena_chunk *chunk; /* New chunk. */
+
+	if (size < a->chunk_size)
+		size = a->chunk_size;
+
+	/* calloc: arena memory is always zeroed. */
+	chunk = calloc(1, ARENA_HDR_SIZE + size);
+	if (chunk == NULL)
+		return (-1);
+
+	chunk->capacity = size;
+	chunk->used     = 0;
+	chunk->next     = a->chunk;
+	a->chunk        = chunk;
+	return (0);
+}
+
+/**
+ * Initializes the arena.
+ *
+ * @param arena Arena structure pointer to be
+ * initialized.
+ *
+ * @return Returns 0 if success and a negative number
+ * otherwise.
+ */
+int arena_init(struct arena **arena)
+{
+	struct arena *out;
+	out = calloc(1, sizeof(struct arena));
+	if (out == NULL)
+		return (-1);
+
+	out->chunk_size = ARENA_DEFAULT_SIZE - ARENA_HDR_SIZE;
+	if (arena_grow(out, out->chunk_size) < 0)
+	{
+		free(out);
+		return (-1);
+	}
+
+	*arena = out;
+	return (0);
+}
+
+/**
+ * Allocates @p size bytes from the arena.
+ *
+ * @param arena Arena structure pointer.
+ * @param size Bytes amount.
+ *
+ * @return Returns a zeroed and ARENA_ALIGN-aligned memory
+ * region, or NULL if error.
+ *
+ * @note Memory given by the arena cannot be freed individually,
+ * everything is released at once in arena_finish().
+ */
+void *arena_alloc(struct arena **arena, size_t size)
+{
+	struct arena *a;  /* Arena.          */
+	void *ptr;        /* Returned block. */
+
+	a = *arena;
+
+	/* Arena exists?. */
+	if (a == NULL || size == 0)
+		return (NULL);
+
+	size = ARENA_ROUND(size);
+
+	/* If no space left, get a new chunk. */
+	if (a->chunk->capacity - a->chunk->used < size)
+		if (arena_grow(a, size) < 0)
+			return (NULL);
+
+	ptr = (char *)a->chunk + ARENA_HDR_SIZE + a->chunk->used;
+	a->chunk->used += size;
+	a->allocated   += size;
+	return (ptr);
+}
+
+/**
+ * Deallocates the arena and everything allocated
+ * from it.
+ *
+ * @param arena Arena structure pointer.
+ *
+ * @return Returns 0 if success.
+ */
+int arena_finish(struct arena **arena)
+{
+	struct arena_chunk *chunk; /* Current chunk. */
+	struct arena_chunk *next;  /* Next chunk.    */
+
+	/* Invalid arena. */
+	if (*arena == NULL)
+		return (-1);
+
+	for (chunk = (*arena)->chunk; chunk != NULL; chunk = next)
+	{
+		next = chunk->next;
+		free(chunk);
+	}
+
+	free(*arena);
+	*arena = NULL;
+	return (0);
+}
@@ -0,0 +1,158 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Davidson Francis <davidsondfgl@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "cache.h"
+#include "hashtable.h"
+#include "libtas.h"
+
+/**
+ * @brief Builds the cache key of a source.
+ *
+ * The key is the MurMur3 of the source content, seeded with
+ * everything else that changes the output: the cache version,
+ * the code generator version (tas_version()), the output format, the memory layout and,
+ * for the hex format only (its header has it), the source name,
+ * so that the other formats are shared among same sources.
+ *
+ * @param src Source buffer.
+ * @param size Source size.
+ * @param name Source name.
+ * @param fmt Output format.
+ * @param mem_size Memory size, in words.
+ * @param pad Whether the image is padded to @p mem_size.
+ * @param key Output key, NUL-terminated.
+ */
+void cache_key(const char *src, size_t size, const char *name, int fmt,
+	size_t mem_size, int pad, char key[CACHE_KEY_LEN + 1])
+{
+	char meta[1024]; /* Key metadata. */
+	uint64_t h[2];   /* Hash.         */
+	int len;         /* Meta length.  */
+
+	len = snprintf(meta, sizeof(meta), "%s|%s|%d|%zu|%d|%s",
+		CACHE_VERSION, tas_version(), fmt, mem_size, !!pad,
+		fmt == TAS_FMT_HEX ? name : "");
+	if (len < 0 || (size_t)len >= sizeof(meta))
+		len = sizeof(meta) - 1;
+
+	hashtable_MurMur3_buffer(meta, (size_t)len, 0, h);
+	hashtable_MurMur3_buffer(src, size, h[0] ^ h[1], h);
+
+	snprintf(key, CACHE_KEY_LEN + 1, "%016" PRIx64 "%016" PRIx64,
+		h[0], h[1]);
+}
+
+/**
+ * @brief Copies the cached output of @p key, if any, to
+ * @p output.
+ *
+ * @param dir Cache directory.
+ * @param key Cache key.
+ * @param fmt Output format.
+ * @param output Output file.
+ *
+ * @return Returns 0 if cache hit and -1 otherwise.
+ */
+int cache_get(const char *dir, const char *key, int fmt, const char *output)
+{
+	char path[PATH_MAX]; /* Cache entry path. */
+	size_t size;         /* Entry size.       */
+	char *buf;           /* Entry content.    */
+	int ret;             /* Return code.      */
+
+	if (snprintf(path, sizeof(path), "%s/%s.%d", dir, key, fmt)
+		>= (int)sizeof(path))
+	{
+		return (-1);
+	}
+
+	if (tas_read_file(path, &buf, &size) < 0)
+		return (-1);
+
+	ret = tas_write_buffer(output, buf, size);
+	free(buf);
+	return (ret);
+}
+
+/**
+ * @brief Adds the output @p buf to the cache, as @p key.
+ *
+ * The entry is written into a temporary file and then renamed,
+ * so concurrent readers and writers never see partial entries.
+ *
+ * @param dir Cache directory, created if not exists.
+ * @param key Cache key.
+ * @param fmt Output format.
+ * @param buf Output buffer.
+ * @param size Output size.
+ *
+ * @return Returns 0 if success and -1 otherwise.
+ */
+int cache_put(const char *dir, const char *key, int fmt, const char *buf,
+	size_t size)
+{
+	char path[PATH_MAX]; /* Cache entry path. */
+	char tmp[PATH_MAX];  /* Temporary path.   */
+	int fd;              /* Temporary fd.     */
+
+	if (mkdir(dir, 0755) < 0 && errno != EEXIST)
+		return (-1);
+
+	if (snprintf(path, sizeof(path), "%s/%s.%d", dir, key, fmt)
+		>= (int)sizeof(path))
+	{
+		return (-1);
+	}
+	if (snprintf(tmp, sizeof(tmp), "%s.XXXXXX", path) >= (int)sizeof(tmp))
+		return (-1);
+
+	if ((fd = mkstemp(tmp)) < 0)
+		return (-1);
+
+	/* mkstemp() creates it as 0600, the cache may be shared. */
+	if (fchmod(fd, 0644) < 0)
+	{
+		close(fd);
+		unlink(tmp);
+		return (-1);
+	}
+	close(fd);
+
+	if (tas_write_buffer(tmp, buf, size) < 0 || rename(tmp, path) < 0)
+	{
+		unlink(tmp);
+		return (-1);
+	}
+	return (0);
+}
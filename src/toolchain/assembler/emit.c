@@ -0,0 +1,358 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Davidson Francis <davidsondfgl@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "libtas.h"
+
+/* Nibble encoders. */
+static const char hex_lower[16] = "0123456789abcdef";
+static const char hex_upper[16] = "0123456789ABCDEF";
+
+/* Intel HEX: data bytes per record. */
+#define IHEX_RECORD 16
+
+/**
+ * @brief Encodes the byte @p b as two hex digits, from the
+ * nibble table @p tbl.
+ *
+ * @param p Output pointer, advanced by 2.
+ * @param b Byte to be encoded.
+ * @param tbl Nibble table.
+ */
+static inline void put_byte(char **p, uint8_t b, const char *tbl)
+{
+	(*p)[0] = tbl[b >> 4];
+	(*p)[1] = tbl[b & 0xF];
+	*p += 2;
+}
+
+/**
+ * @brief Formats the image as a $readmemh hex file, i.e: one
+ * '%04x' word per line.
+ */
+static char *format_hex(char *p, const struct tas_image *img,
+	const char *name)
+{
+	p += sprintf(p, "// %s file\n", name);
+	for (size_t i = 0; i < img->size; i++)
+	{
+		put_byte(&p, img->code[i] >> 8, hex_lower);
+		put_byte(&p, img->code[i] & 0xFF, hex_lower);
+		*p++ = '\n';
+	}
+	return (p);
+}
+
+/**
+ * @brief Formats the image as raw binary, each word in
+ * little (@p be == 0) or big-endian (@p be == 1).
+ */
+static char *format_bin(char *p, const struct tas_image *img, int be)
+{
+	for (size_t i = 0; i < img->size; i++)
+	{
+		p[be]  = img->code[i] & 0xFF;
+		p[!be] = img->code[i] >> 8;
+		p += 2;
+	}
+	return (p);
+}
+
+/**
+ * @brief Emits a single Intel HEX record.
+ */
+static char *ihex_record(char *p, uint8_t type, uint16_t addr,
+	const uint8_t *data, size_t len)
+{
+	uint8_t sum; /* Checksum. */
+
+	sum = len + (addr >> 8) + (addr & 0xFF) + type;
+	*p++ = ':';
+	put_byte(&p, len, hex_upper);
+	put_byte(&p, addr >> 8, hex_upper);
+	put_byte(&p, addr & 0xFF, hex_upper);
+	put_byte(&p, type, hex_upper);
+	for (size_t i = 0; i < len; i++)
+	{
+		put_byte(&p, data[i], hex_upper);
+		sum += data[i];
+	}
+	put_byte(&p, -sum, hex_upper);
+	*p++ = '\n';
+	return (p);
+}
+
+/**
+ * @brief Formats the image as Intel HEX, byte addressed with
+ * each word stored big-endian, i.e: in the same order as the
+ * hex file.
+ */
+static char *format_ihex(char *p, const struct tas_image *img)
+{
+	uint8_t data[IHEX_RECORD]; /* Record data.     */
+	size_t bytes;              /* Image size.      */
+	size_t addr;               /* Current address. */
+	size_t len;                /* Record length.   */
+	uint8_t ext[2];            /* Upper address.   */
+
+	bytes = img->size * 2;
+	for (addr = 0; addr < bytes; addr += len)
+	{
+		/* Extended linear address, at each 64kB. */
+		if (addr && !(addr & 0xFFFF))
+		{
+			ext[0] = (addr >> 24) & 0xFF;
+			ext[1] = (addr >> 16) & 0xFF;
+			p = ihex_record(p, 0x04, 0, ext, 2);
+		}
+
+		len = bytes - addr;
+		if (len > IHEX_RECORD)
+			len = IHEX_RECORD;
+
+		for (size_t i = 0; i < len; i += 2)
+		{
+			data[i]     = img->code[(addr + i) / 2] >> 8;
+			data[i + 1] = img->code[(addr + i) / 2] & 0xFF;
+		}
+		p = ihex_record(p, 0x00, addr & 0xFFFF, data, len);
+	}
+	return (ihex_record(p, 0x01, 0, NULL, 0));
+}
+
+/**
+ * @brief Formats the image as a Gowin memory initialization
+ * (.mi) file.
+ */
+static char *format_mi(char *p, const struct tas_image *img)
+{
+	p += sprintf(p, "#File_format=Hex\n#Address_depth=%zu\n"
+		"#Data_width=16\n", img->size ? img->size : 1);
+	for (size_t i = 0; i < img->size; i++)
+	{
+		put_byte(&p, img->code[i] >> 8, hex_upper);
+		put_byte(&p, img->code[i] & 0xFF, hex_upper);
+		*p++ = '\n';
+	}
+	return (p);
+}
+
+/**
+ * @brief Formats the image @p img into a single buffer.
+ *
+ * @param img  Image to be formatted.
+ * @param fmt  Output format.
+ * @param name Source name, used by the formats that have
+ *             a header, may be NULL.
+ * @param buf  Output buffer, must be released with free().
+ * @param size Output buffer size.
+ *
+ * @return Returns 0 if success and -1 otherwise.
+ */
+int tas_format_image(const struct tas_image *img, enum tas_format fmt,
+	const char *name, char **buf, size_t *size)
+{
+	size_t records; /* Intel HEX records. */
+	size_t max;     /* Buffer size bound. */
+	char *p;        /* Current position.  */
+
+	if (!img || !buf || !size || (!img->code && img->size))
+		return (-1);
+
+	name = name ? name : "";
+
+	/* Buffer size upper bound. */
+	switch (fmt)
+	{
+		case TAS_FMT_HEX:
+			max = strlen(name) + 16 + img->size * 5;
+			break;
+		case TAS_FMT_BIN_LE:
+		case TAS_FMT_BIN_BE:
+			max = img->size * 2;
+			break;
+		case TAS_FMT_IHEX:
+			records = (img->size * 2 + IHEX_RECORD - 1) / IHEX_RECORD;
+			max = (records * 2 + 1) * (12 + IHEX_RECORD * 2);
+			break;
+		case TAS_FMT_MI:
+			max = 64 + img->size * 5;
+			break;
+		default:
+			return (-1);
+	}
+
+	/* +1: sprintf NUL. */
+	if ((*buf = malloc(max + 1)) == NULL)
+		return (-1);
+
+	p = *buf;
+	switch (fmt)
+	{
+		case TAS_FMT_HEX:
+			p = format_hex(p, img, name);
+			break;
+		case TAS_FMT_BIN_LE:
+		case TAS_FMT_BIN_BE:
+			p = format_bin(p, img, fmt == TAS_FMT_BIN_BE);
+			break;
+		case TAS_FMT_IHEX:
+			p = format_ihex(p, img);
+			break;
+		case TAS_FMT_MI:
+			p = format_mi(p, img);
+			break;
+	}
+
+	*size = (size_t)(p - *buf);
+	return (0);
+}
+
+/**
+ * @brief Writes the buffer @p buf to @p file, in a single
+ * write (or as few as the kernel allows).
+ *
+ * @param file Output file, if '-', writes to stdout.
+ * @param buf  Buffer to be written.
+ * @param size Buffer size.
+ *
+ * @return Returns 0 if success and -1 otherwise.
+ */
+int tas_write_buffer(const char *file, const char *buf, size_t size)
+{
+	size_t off; /* Written bytes. */
+	ssize_t w;  /* Write return.  */
+	int ret;    /* Return code.   */
+	int fd;     /* Output fd.     */
+
+	if (!file || (!buf && size))
+		return (-1);
+
+	if (!strcmp(file, "-"))
+		fd = STDOUT_FILENO;
+	else if ((fd = open(file, O_WRONLY|O_CREAT|O_TRUNC, 0644)) < 0)
+		return (-1);
+
+	ret = 0;
+	for (off = 0; off < size; off += (size_t)w)
+	{
+		if ((w = write(fd, buf + off, size - off)) < 0)
+		{
+			if (errno == EINTR)
+			{
+				w = 0;
+				continue;
+			}
+			ret = -1;
+			break;
+		}
+	}
+
+	if (fd != STDOUT_FILENO && close(fd) < 0)
+		ret = -1;
+
+	return (ret);
+}
+
+/**
+ * @brief Formats the image @p img and writes it to @p file.
+ *
+ * @param img  Image to be written.
+ * @param fmt  Output format.
+ * @param name Source name, see tas_format_image().
+ * @param file Output file, if '-', writes to stdout.
+ *
+ * @return Returns 0 if success and -1 otherwise.
+ */
+int tas_write_image(const struct tas_image *img, enum tas_format fmt,
+	const char *name, const char *file)
+{
+	size_t size; /* Buffer size.   */
+	char *buf;   /* Output buffer. */
+	int ret;     /* Return code.   */
+
+	if (!file || tas_format_image(img, fmt, name, &buf, &size) < 0)
+		return (-1);
+
+	ret = tas_write_buffer(file, buf, size);
+	free(buf);
+	return (ret);
+}
+
+/**
+ * @brief Writes the symbols of @p img to @p file, for the profiler
+ * (toolchain/prof), one entry per line:
+ *   f <source name>
+ *   s <address> <label>  # labels, in order of definition
+ *   l <address> <line>   # source line, per word
+ *
+ * Addresses are in hex and padding words have no line entry.
+ *
+ * @param img  Assembled image.
+ * @param name Source name.
+ * @param file Output file, if '-', writes to stdout.
+ *
+ * @return Returns 0 if success and -1 otherwise.
+ */
+int tas_write_symbols(const struct tas_image *img, const char *name,
+	const char *file)
+{
+	size_t size; /* Buffer size.   */
+	char *buf;   /* Output buffer. */
+	char *p;     /* Current char.  */
+	int ret;     /* Return code.   */
+
+	if (!img || !file)
+		return (-1);
+
+	name = name ? name : "<buffer>";
+
+	/* Worst case: 16-bit addresses and 32-bit lines. */
+	size = strlen(name) + 4 + img->size * 18;
+	for (size_t i = 0; i < img->nsyms; i++)
+		size += strlen(img->syms[i].name) + 20;
+
+	if ((buf = malloc(size + 1)) == NULL)
+		return (-1);
+
+	p  = buf;
+	p += sprintf(p, "f %s\n", name);
+	for (size_t i = 0; i < img->nsyms; i++)
+		p += sprintf(p, "s %04zx %s\n", img->syms[i].addr,
+			img->syms[i].name);
+
+	for (size_t i = 0; img->lines && i < img->size; i++)
+		if (img->lines[i] > 0)
+			p += sprintf(p, "l %04zx %d\n", i, img->lines[i]);
+
+	ret = tas_write_buffer(file, buf, (size_t)(p - buf));
+	free(buf);
+	return (ret);
+}
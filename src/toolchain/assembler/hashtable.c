@@ -35,6 +35,10 @@
  * @param ht Hashtable structure pointer to be
  * initialized.
  *
+ * @param setup_algorithm Setup function: sets the hash function,
+ * comparator, key size and collision resolution scheme
+ * (separate chaining or open addressing).
+ *
  * @return Returns 0 if success and a negative number
  * otherwise.
  */
@@ -50,12 +54,6 @@ int hashtable_init(
 
 	out->capacity = HASHTABLE_DEFAULT_SIZE;
 	out->elements = 0;
-	out->bucket = calloc(out->capacity, sizeof(void *));
-	if (out->bucket == NULL)
-	{
-		free(out);
-		return (-1);
-	}
 
 	/*
 	 * Setup algorith, comparator and key size.
@@ -67,6 +65,18 @@ int hashtable_init(
 	else
 		hashtable_splitmix64_setup(&out);
 
+	/* Buckets or slots, accordingly to the chosen scheme. */
+	if (out->open_addressing)
+		out->slots = calloc(out->capacity, sizeof(struct list));
+	else
+		out->bucket = calloc(out->capacity, sizeof(void *));
+
+	if (out->slots == NULL && out->bucket == NULL)
+	{
+		free(out);
+		return (-1);
+	}
+
 	*ht = out;
 	return (0);
 }
@@ -100,7 +110,13 @@ int hashtable_iter_init(
 	/* Fill the first position. */
 	for (size_t i = 0; i < h->capacity; i++)
 	{
-		struct list *l_ptr = h->bucket[i];
+		struct list *l_ptr;
+
+		if (h->open_addressing)
+			l_ptr = (h->slots[i].key != NULL) ? &h->slots[i] : NULL;
+		else
+			l_ptr = h->bucket[i];
+
 		if (l_ptr != NULL)
 		{
 			it->next = l_ptr;
@@ -132,18 +148,27 @@ int hashtable_iter_next(
 	if (it->next)
 	{
 		*li = it->next;
-		it->next = it->next->next;
+		if (it->ht->open_addressing)
+			it->next = NULL;
+		else
+			it->next = it->next->next;
 		return (0);
 	}
 
 	/* If not, let us search through the buckets. */
 	for (size_t i = it->bucket_index + 1; i < it->ht->capacity; i++)
 	{
-		struct list *l_ptr = it->ht->bucket[i];
+		struct list *l_ptr;
+
+		if (it->ht->open_addressing)
+			l_ptr = (it->ht->slots[i].key != NULL) ? &it->ht->slots[i] : NULL;
+		else
+			l_ptr = it->ht->bucket[i];
+
 		if (l_ptr != NULL)
 		{
 			*li = l_ptr;
-			it->next = l_ptr->next;
+			it->next = it->ht->open_addressing ? NULL : l_ptr->next;
 			it->bucket_index = i;
 			return (0);
 		}
@@ -172,6 +197,19 @@ int hashtable_finish(struct hashtable **ht, int dealloc)
 	if (h == NULL)
 		return (-1);
 
+	/* Open addressing: entries live inside the slots. */
+	if (h->open_addressing)
+	{
+		if (dealloc)
+			for (size_t i = 0; i < h->capacity; i++)
+				if (h->slots[i].key != NULL)
+					free(h->slots[i].value);
+
+		free(h->slots);
+		free(h);
+		return (0);
+	}
+
 	/*
 	 * For each bucket, deallocates each list.
 	 */
@@ -186,7 +224,10 @@ int hashtable_finish(struct hashtable **ht, int dealloc)
 			if (dealloc)
 				free(l_ptr->value);
 
-			free(l_ptr);
+			/* Arena nodes are released along with the arena. */
+			if (h->arena == NULL)
+				free(l_ptr);
+
 			l_ptr = l_ptr_next;
 		}
 	}
@@ -197,33 +238,199 @@ int hashtable_finish(struct hashtable **ht, int dealloc)
 }
 
 /**
- * @brief Calculates the bucket size accordingly with the
- * current hash function set and the current hashtable
- * capacity.
+ * @brief Makes the hashtable allocate its list nodes from the
+ * arena @p arena, instead of one malloc per node.
  *
  * @param ht Hashtable pointer.
- * @param key Key to be hashed.
+ * @param arena Arena to allocate from, must outlive the hashtable.
  *
- * @return Returns a value between [0,h->capacity] that
- * should be used to address the target bucket for the
- * hash table.
+ * @return Returns 0 if success and a negative number otherwise.
+ *
+ * @note This must be called before adding any element. Open
+ * addressing hashtables do not allocate nodes at all, so
+ * the arena is unused there.
  */
-inline static size_t hashtable_bucket_index(struct hashtable **ht, const void *key)
+int hashtable_set_arena(struct hashtable **ht, struct arena *arena)
 {
-	struct hashtable *h;  /* Hashtable.    */
-	uint64_t hash;        /* Hash value.   */
-	size_t index;         /* Bucket index. */
+	struct hashtable *h; /* Hashtable. */
+
+	h = *ht;
+
+	/* Invalid or non-empty hashtable. */
+	if (h == NULL || h->elements != 0)
+		return (-1);
+
+	h->arena = arena;
+	return (0);
+}
+
+/**
+ * @brief Checks whether the hashtable reached its threshold
+ * of 60% and thus, needs to grow.
+ *
+ * @param h Hashtable pointer.
+ *
+ * @return Returns 1 if needs to grow, 0 otherwise.
+ */
+static inline int hashtable_is_full(struct hashtable *h)
+{
+	return (h->elements >= h->capacity*0.6);
+}
+
+/**
+ * @brief Grows (twice) a separate chaining hashtable.
+ *
+ * Since the full hash is kept in each entry, nothing is
+ * re-hashed here.
+ *
+ * @param h Hashtable pointer.
+ *
+ * @return Returns 0 if success and a negative number otherwise.
+ */
+static int hashtable_grow_chaining(struct hashtable *h)
+{
+	struct list **new_buckets; /* New buckets.   */
+	struct list *l_ptr_nxt;    /* List pointer.  */
+	struct list *l_ptr;        /* List pointer.  */
+	size_t old_capacity;       /* Old capacity.  */
+	size_t index;              /* Bucket index.  */
+
+	/* Allocate new buckets. */
+	new_buckets = calloc(h->capacity << 1, sizeof(void *));
+	if (new_buckets == NULL)
+		return (-1);
+
+	old_capacity  = h->capacity;
+	h->capacity <<= 1;
+
+#if HASHTABLE_DEBUG
+	h->collisions = 0;
+#endif
+
+	/* Move elements to it. */
+	for (size_t i = 0; i < old_capacity; i++)
+	{
+		l_ptr = h->bucket[i];
+		while (l_ptr != NULL)
+		{
+			l_ptr_nxt = l_ptr->next;
+
+			if (l_ptr->key != NULL)
+			{
+				index = l_ptr->hash & (h->capacity - 1);
+				l_ptr->next = new_buckets[index];
+#if HASHTABLE_DEBUG
+				if(new_buckets[index] != NULL)
+					h->collisions++;
+#endif
+				new_buckets[index] = l_ptr;
+			}
+
+			l_ptr = l_ptr_nxt;
+		}
+	}
+
+	free(h->bucket);
+	h->bucket = new_buckets;
+	return (0);
+}
+
+/**
+ * @brief Grows (twice) an open addressing hashtable.
+ *
+ * Since the full hash is kept in each slot, nothing is
+ * re-hashed here.
+ *
+ * @param h Hashtable pointer.
+ *
+ * @return Returns 0 if success and a negative number otherwise.
+ */
+static int hashtable_grow_open(struct hashtable *h)
+{
+	struct list *new_slots; /* New slots.    */
+	size_t old_capacity;    /* Old capacity. */
+	size_t index;           /* Slot index.   */
+	size_t mask;            /* Index mask.   */
+
+	/* Allocate new slots. */
+	new_slots = calloc(h->capacity << 1, sizeof(struct list));
+	if (new_slots == NULL)
+		return (-1);
+
+	old_capacity  = h->capacity;
+	h->capacity <<= 1;
+	mask = h->capacity - 1;
+
+#if HASHTABLE_DEBUG
+	h->collisions = 0;
+#endif
+
+	/* Move elements to it, linear probing. */
+	for (size_t i = 0; i < old_capacity; i++)
+	{
+		if (h->slots[i].key == NULL)
+			continue;
+
+		index = h->slots[i].hash & mask;
+		while (new_slots[index].key != NULL)
+		{
+#if HASHTABLE_DEBUG
+			h->collisions++;
+#endif
+			index = (index + 1) & mask;
+		}
+		new_slots[index] = h->slots[i];
+	}
+
+	free(h->slots);
+	h->slots = new_slots;
+	return (0);
+}
+
+/**
+ * @brief Adds the current @p key and @p value into an open
+ * addressing hashtable.
+ *
+ * @param h Hashtable pointer.
+ * @param key Key to be added.
+ * @param value Value to be added.
+ * @param hash Key hash.
+ *
+ * @return Returns 0 if success and a negative number otherwise.
+ */
+static int hashtable_add_open(struct hashtable *h, void *key, void *value,
+	uint64_t hash)
+{
+	struct list *slot; /* Current slot. */
+	size_t index;      /* Slot index.   */
+	size_t mask;       /* Index mask.   */
+
+	mask  = h->capacity - 1;
+	index = hash & mask;
 
 	/*
-	 * Its important to note that the hashtable->capacity
-	 * will always be power of 2, thus, allowing the &-1
-	 * as a modulus operation.
+	 * Probes until an empty slot, if the key already exists,
+	 * overwrite the value.
 	 */
-	h = *ht;
-	hash  = h->hash(key, h->key_size);
-	index = hash & (h->capacity - 1);
+	for (slot = &h->slots[index]; slot->key != NULL;
+		slot = &h->slots[index])
+	{
+		if (slot->hash == hash && h->cmp(slot->key, key) == 0)
+		{
+			slot->value = value;
+			return (0);
+		}
+#if HASHTABLE_DEBUG
+		h->collisions++;
+#endif
+		index = (index + 1) & mask;
+	}
 
-	return (index);
+	slot->key   = key;
+	slot->value = value;
+	slot->hash  = hash;
+	h->elements++;
+	return (0);
 }
 
 /**
@@ -243,8 +450,8 @@ int hashtable_add(struct hashtable **ht, void *key, void *value)
 	struct hashtable *h;    /* Hashtable.    */
 	struct list *l_entry;   /* List entry.   */
 	struct list *l_ptr;     /* List pointer. */
-	struct list *l_ptr_nxt; /* List pointer. */
-	size_t hash;            /* Hash value.   */
+	uint64_t hash;          /* Hash value.   */
+	size_t index;           /* Bucket index. */
 
 	h = *ht;
 
@@ -253,62 +460,39 @@ int hashtable_add(struct hashtable **ht, void *key, void *value)
 		return (-1);
 
 	/* Asserts if we have space enough. */
-	if (h->elements >= h->capacity*0.6)
+	if (hashtable_is_full(h))
 	{
-		size_t old_capacity;
-		struct list **new_buckets;
-
-		/* Allocate new buckets. */
-		new_buckets = calloc(h->capacity << 1, sizeof(void *));
-		if (new_buckets == NULL)
-			return (-1);
-
-		old_capacity  = h->capacity;
-		h->capacity <<= 1;
-
-#if HASHTABLE_DEBUG
-		h->collisions = 0;
-#endif
-
-		/* Move elements to it. */
-		for (size_t i = 0; i < old_capacity; i++)
+		if (h->open_addressing)
 		{
-			l_ptr = h->bucket[i];
-			while (l_ptr != NULL)
-			{
-				l_ptr_nxt = l_ptr->next;
-
-				if (l_ptr->key != NULL)
-				{
-					/* Recalculates the hash for each key inside the bucket. */
-					hash = hashtable_bucket_index(ht, l_ptr->key);
-					l_ptr->next = new_buckets[hash];
-#if HASHTABLE_DEBUG
-					if(new_buckets[hash] != NULL)
-						h->collisions++;
-#endif
-					new_buckets[hash] = l_ptr;
-				}
-
-				l_ptr = l_ptr_nxt;
-			}
+			if (hashtable_grow_open(h) < 0)
+				return (-1);
 		}
-
-		free(h->bucket);
-		h->bucket = new_buckets;
+		else if (hashtable_grow_chaining(h) < 0)
+			return (-1);
 	}
 
-	/* Hash it. */
-	hash = hashtable_bucket_index(ht, key);
+	/*
+	 * Hash it.
+	 *
+	 * Its important to note that the hashtable->capacity
+	 * will always be power of 2, thus, allowing the &-1
+	 * as a modulus operation.
+	 */
+	hash = h->hash(key, h->key_size);
+
+	if (h->open_addressing)
+		return (hashtable_add_open(h, key, value, hash));
+
+	index = hash & (h->capacity - 1);
 
 	/*
 	 * Loops through the list in order to see if the key already exists,
 	 * if so, overwrite the value.
 	 */
-	l_ptr = h->bucket[hash];
+	l_ptr = h->bucket[index];
 	while (l_ptr != NULL)
 	{
-		if (l_ptr->key != NULL && h->cmp(l_ptr->key, key) == 0)
+		if (l_ptr->hash == hash && h->cmp(l_ptr->key, key) == 0)
 		{
 			l_ptr->value = value;
 			return (0);
@@ -317,7 +501,11 @@ int hashtable_add(struct hashtable **ht, void *key, void *value)
 	}
 
 	/* Allocate a new list and adds into the appropriate location. */
-	l_entry = calloc(1, sizeof(struct list));
+	if (h->arena != NULL)
+		l_entry = arena_alloc(&h->arena, sizeof(struct list));
+	else
+		l_entry = calloc(1, sizeof(struct list));
+
 	if (l_entry == NULL)
 		return (-1);
 
@@ -325,15 +513,15 @@ int hashtable_add(struct hashtable **ht, void *key, void *value)
 	l_entry->key = key;
 	l_entry->value = value;
 	l_entry->hash = hash;
-	l_entry->next = h->bucket[hash];
+	l_entry->next = h->bucket[index];
 
 	/* Add into the top of the buckets list. */
 #if HASHTABLE_DEBUG
-	if (h->bucket[hash] != NULL)
+	if (h->bucket[index] != NULL)
 		h->collisions++;
 #endif
 
-	h->bucket[hash] = l_entry;
+	h->bucket[index] = l_entry;
 	h->elements++;
 
 	return (0);
@@ -347,12 +535,17 @@ int hashtable_add(struct hashtable **ht, void *key, void *value)
  *
  * @return Returns the value belonging to the @p key, or NULL
  * if not found.
+ *
+ * @note Keys are only compared if the stored hash matches
+ * the @p key hash.
  */
 void* hashtable_get(struct hashtable **ht, void *key)
 {
 	struct hashtable *h;   /* Hashtable.    */
 	struct list *l_ptr;    /* List pointer. */
 	uint64_t hash;         /* Hash value.   */
+	size_t index;          /* Bucket index. */
+	size_t mask;           /* Index mask.   */
 
 	h = *ht;
 
@@ -361,16 +554,31 @@ void* hashtable_get(struct hashtable **ht, void *key)
 		return (NULL);
 
 	/* Hash it. */
-	hash = hashtable_bucket_index(ht, key);
+	hash  = h->hash(key, h->key_size);
+	mask  = h->capacity - 1;
+	index = hash & mask;
+
+	/* Open addressing: probes until an empty slot. */
+	if (h->open_addressing)
+	{
+		for (l_ptr = &h->slots[index]; l_ptr->key != NULL;
+			l_ptr = &h->slots[index])
+		{
+			if (l_ptr->hash == hash && h->cmp(l_ptr->key, key) == 0)
+				return (l_ptr->value);
+			index = (index + 1) & mask;
+		}
+		return (NULL);
+	}
 
 	/*
 	 * Loops through the list in order to see if the key exists,
 	 * if so, gets the value.
 	 */
-	l_ptr = h->bucket[hash];
+	l_ptr = h->bucket[index];
 	while (l_ptr != NULL)
 	{
-		if (l_ptr->key != NULL && h->cmp(l_ptr->key, key) == 0)
+		if (l_ptr->hash == hash && h->cmp(l_ptr->key, key) == 0)
 			return (l_ptr->value);
 
 		l_ptr = l_ptr->next;
@@ -463,6 +671,17 @@ void hashtable_sdbm_setup(struct hashtable **ht)
 	(*ht)->key_size = 1;
 }
 
+/**
+ * @brief Setup for the sdbm hash function, open addressing.
+ *
+ * @param ht Hashtable pointer.
+ */
+void hashtable_sdbm_oa_setup(struct hashtable **ht)
+{
+	hashtable_sdbm_setup(ht);
+	(*ht)->open_addressing = 1;
+}
+
 /*----------------------------------------------------------------------------*
  * Based in splitmix64, from Better Bit Mixing - Improving on MurmurHash3's   *
  * 64-bit Finalizer                                                           *
@@ -507,6 +726,17 @@ void hashtable_splitmix64_setup(struct hashtable **ht)
 	(*ht)->key_size = sizeof(void *);
 }
 
+/**
+ * @brief Setup for the splitmix64 hash function, open addressing.
+ *
+ * @param ht Hashtable pointer.
+ */
+void hashtable_splitmix64_oa_setup(struct hashtable **ht)
+{
+	hashtable_splitmix64_setup(ht);
+	(*ht)->open_addressing = 1;
+}
+
 /*---------------------------------------------------------------------------*
  * MurMur3 Hash Functions                                                    *
  *---------------------------------------------------------------------------*/
@@ -523,6 +753,17 @@ void hashtable_MurMur3_setup(struct hashtable **ht)
 	(*ht)->key_size = sizeof(void *);
 }
 
+/**
+ * @brief Setup for the MurMur3 hash function, open addressing.
+ *
+ * @param ht Hashtable pointer.
+ */
+void hashtable_MurMur3_oa_setup(struct hashtable **ht)
+{
+	hashtable_MurMur3_setup(ht);
+	(*ht)->open_addressing = 1;
+}
+
 /* ---------------- *
  * MurMur Helpers   *
  * ---------------- */
@@ -619,6 +860,105 @@ uint64_t hashtable_MurMur3_hash(const void *key, size_t size)
 	return (h1);
 }
 
+/**
+ * @brief MurMur3 (x64, 128-bit) over the content of the
+ * buffer @p key, unlike hashtable_MurMur3_hash(), that
+ * only hashes the pointer.
+ *
+ * Also based in: https://github.com/aappleby/smhasher.
+ *
+ * @param key Buffer to be hashed.
+ * @param size Buffer size, in bytes.
+ * @param seed Hash seed.
+ * @param out Resulting 128-bit hash.
+ */
+void hashtable_MurMur3_buffer(const void *key, size_t size, uint64_t seed,
+	uint64_t out[2])
+{
+	const uint8_t *data = key;
+	const uint8_t *tail;
+	const size_t nblocks = size / 16;
+
+	uint64_t h1 = seed;
+	uint64_t h2 = seed;
+	uint64_t k1;
+	uint64_t k2;
+
+	const uint64_t c1 = 0x87c37b91114253d5;
+	const uint64_t c2 = 0x4cf5ad432745937f;
+
+	/* Body. */
+	for (size_t i = 0; i < nblocks; i++)
+	{
+		memcpy(&k1, data + i * 16, sizeof(k1));
+		memcpy(&k2, data + i * 16 + 8, sizeof(k2));
+
+		k1 *= c1;
+		k1  = rotl64(k1, 31);
+		k1 *= c2;
+		h1 ^= k1;
+		h1 = rotl64(h1, 27);
+		h1 += h2;
+		h1 = h1 * 5 + 0x52dce729;
+
+		k2 *= c2;
+		k2  = rotl64(k2, 33);
+		k2 *= c1;
+		h2 ^= k2;
+		h2 = rotl64(h2, 31);
+		h2 += h1;
+		h2 = h2 * 5 + 0x38495ab5;
+	}
+
+	/* Tail. */
+	tail = data + nblocks * 16;
+	k1 = 0;
+	k2 = 0;
+
+	switch (size & 15)
+	{
+		case 15: k2 ^= (uint64_t)tail[14] << 48; /* fallthrough */
+		case 14: k2 ^= (uint64_t)tail[13] << 40; /* fallthrough */
+		case 13: k2 ^= (uint64_t)tail[12] << 32; /* fallthrough */
+		case 12: k2 ^= (uint64_t)tail[11] << 24; /* fallthrough */
+		case 11: k2 ^= (uint64_t)tail[10] << 16; /* fallthrough */
+		case 10: k2 ^= (uint64_t)tail[ 9] << 8;  /* fallthrough */
+		case  9: k2 ^= (uint64_t)tail[ 8];
+			k2 *= c2;
+			k2  = rotl64(k2, 33);
+			k2 *= c1;
+			h2 ^= k2;
+			/* fallthrough */
+		case  8: k1 ^= (uint64_t)tail[ 7] << 56; /* fallthrough */
+		case  7: k1 ^= (uint64_t)tail[ 6] << 48; /* fallthrough */
+		case  6: k1 ^= (uint64_t)tail[ 5] << 40; /* fallthrough */
+		case  5: k1 ^= (uint64_t)tail[ 4] << 32; /* fallthrough */
+		case  4: k1 ^= (uint64_t)tail[ 3] << 24; /* fallthrough */
+		case  3: k1 ^= (uint64_t)tail[ 2] << 16; /* fallthrough */
+		case  2: k1 ^= (uint64_t)tail[ 1] << 8;  /* fallthrough */
+		case  1: k1 ^= (uint64_t)tail[ 0];
+			k1 *= c1;
+			k1  = rotl64(k1, 31);
+			k1 *= c2;
+			h1 ^= k1;
+	}
+
+	/* Finalization. */
+	h1 ^= size; h2 ^= size;
+
+	h1 += h2;
+	h2 += h1;
+
+	h1 = fmix64(h1);
+	h2 = fmix64(h2);
+
+	h1 += h2;
+	h2 += h1;
+
+	out[0] = h1;
+	out[1] = h2;
+}
+
 /*===========================================================================*
  *                               -.- Tests -.-                               *
  *===========================================================================*/
@@ -632,6 +972,47 @@ uint64_t hashtable_MurMur3_hash(const void *key, size_t size)
 /* Considers each element as an integer value. */
 #define BUCKET_AS_INTEGER 0
 
+/**
+ * @brief Print some statistics regarding the slots usage and
+ * probe lengths of an open addressing hashtable.
+ *
+ * @param h Hashtable pointer.
+ */
+static void hashtable_print_stats_open(struct hashtable *h)
+{
+	size_t max_probe;  /* Max probe length.   */
+	size_t probes;     /* Total probe length. */
+	size_t dist;       /* Slot displacement.  */
+	size_t mask;       /* Index mask.         */
+
+	max_probe = 0;
+	probes = 0;
+	mask = h->capacity - 1;
+
+	for (size_t i = 0; i < h->capacity; i++)
+	{
+		if (h->slots[i].key == NULL)
+			continue;
+
+		/* Distance from the 'home' slot. */
+		dist = (i - (h->slots[i].hash & mask)) & mask;
+		probes += dist + 1;
+		if (dist + 1 > max_probe)
+			max_probe = dist + 1;
+	}
+
+	printf("--------------------------- Stats ---------------------------\n");
+	printf("Slots available: %zu\n", h->capacity);
+	printf("Used slots: %zu (%f%%)\n", h->elements,
+		((double)h->elements/h->capacity)*100);
+	printf("Max probe length: %zu\n", max_probe);
+	printf("Mean probe length: %f\n", (double)probes/h->elements);
+#if HASHTABLE_DEBUG
+	printf("Collisions: %zu, elements: %zu\n", h->collisions, h->elements);
+#endif
+	printf("-------------------------------------------------------------\n");
+}
+
 /**
  * @brief Print some statistics regarding the bucket usage, collisions
  * and etc, useful to know if the currently hash function used is
@@ -666,6 +1047,12 @@ void hashtable_print_stats(struct hashtable **ht)
 	if (h == NULL || h->elements < 1)
 		return;
 
+	if (h->open_addressing)
+	{
+		hashtable_print_stats_open(h);
+		return;
+	}
+
 #if DUMP_BUCKET
 	printf("Buckets:\n");
 #endif
@@ -728,7 +1115,7 @@ void hashtable_print_stats(struct hashtable **ht)
 	printf("-------------------------------------------------------------\n");
 }
 
-#if 0
+#ifdef HASHTABLE_SELFTEST
 /**
  * @brief Hashtable integrity test.
  *
@@ -790,6 +1177,14 @@ static int hashtable_integritytest(struct hashtable *ht)
 		l = 0;
 		r = ARRAY_SIZE - 1;
 
+		/* Each number was added as both key and value. */
+		if (key != num)
+		{
+			fprintf(stderr, "hashtable: error, key: %p / value: %p\n",
+				(void *)key, (void *)num);
+			goto out1;
+		}
+
 		/* Binary search, in order to confirm if the number
 		 * really exists in the original array. */
 		while (l <= r)
@@ -825,23 +1220,43 @@ out2:
 
 
 /**
- * @brief Execute tests
+ * @brief Execute tests, for each collision scheme: separate
+ * chaining and open addressing (as the label table).
  */
 int main(void)
 {
+	static const struct
+	{
+		const char *name;
+		void (*setup)(struct hashtable **ht);
+	} setups[] = {
+		{"splitmix64",                    hashtable_splitmix64_setup},
+		{"splitmix64, open addressing",   hashtable_splitmix64_oa_setup},
+		{"MurMur3",                       hashtable_MurMur3_setup},
+		{"MurMur3, open addressing",      hashtable_MurMur3_oa_setup},
+	};
 	struct hashtable *ht;
+	int ret = EXIT_SUCCESS;
+	int failed;
 
-	/* Allocate hashtable. */
-	if (hashtable_init(&ht, NULL))
+	for (size_t i = 0; i < sizeof(setups) / sizeof(setups[0]); i++)
 	{
-		fprintf(stderr, "hashtable: error while allocating hashtable\n");
-		exit(EXIT_FAILURE);
-	}
+		/* Allocate hashtable. */
+		if (hashtable_init(&ht, setups[i].setup))
+		{
+			fprintf(stderr, "hashtable: error while allocating hashtable\n");
+			exit(EXIT_FAILURE);
+		}
 
-	/* Tests. */
-	printf("Hashtable integrity test [%s]\n",
-		!hashtable_integritytest(ht) ? "PASSED" : "FAILED");
+		/* Tests. */
+		failed = hashtable_integritytest(ht);
+		printf("Hashtable integrity test (%s) [%s]\n", setups[i].name,
+			!failed ? "PASSED" : "FAILED");
+		if (failed)
+			ret = EXIT_FAILURE;
 
-	hashtable_finish(&ht, 0);
+		hashtable_finish(&ht, 0);
+	}
+	return (ret);
 }
 #endif
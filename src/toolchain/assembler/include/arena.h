@@ -0,0 +1,66 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Davidson Francis <davidsondfgl@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+	#include <stddef.h>
+
+	/**
+	 * Arena default chunk size, in bytes.
+	 */
+	#define ARENA_DEFAULT_SIZE (64 * 1024)
+
+	/**
+	 * Allocation alignment, must be power of 2.
+	 */
+	#define ARENA_ALIGN 16
+
+	/**
+	 * Arena chunk, allocations are served from
+	 * the trailing data.
+	 */
+	struct arena_chunk
+	{
+		struct arena_chunk *next; /* Previous chunk.  */
+		size_t capacity;          /* Data size.       */
+		size_t used;              /* Used data bytes. */
+	};
+
+	/**
+	 * Arena structure.
+	 */
+	struct arena
+	{
+		struct arena_chunk *chunk; /* Current chunk.     */
+		size_t chunk_size;         /* Chunks data size.  */
+		size_t allocated;          /* Total bytes given. */
+	};
+
+	/* External functions. */
+	extern int arena_init(struct arena **arena);
+	extern void *arena_alloc(struct arena **arena, size_t size);
+	extern int arena_finish(struct arena **arena);
+
+#endif /* ARENA_H */
@@ -0,0 +1,50 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Davidson Francis <davidsondfgl@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CACHE_H
+#define CACHE_H
+
+	#include <stddef.h>
+
+	/**
+	 * Cache key length, in chars: 128-bit hash, in hex.
+	 */
+	#define CACHE_KEY_LEN 32
+
+	/**
+	 * Bump whenever the cache layout or key changes, so old
+	 * cache entries are no longer used. Code generator changes
+	 * bump TAS_VERSION (libtas.c) instead.
+	 */
+	#define CACHE_VERSION "tas-cache-1"
+
+	/* External functions. */
+	extern void cache_key(const char *src, size_t size, const char *name,
+		int fmt, size_t mem_size, int pad, char key[CACHE_KEY_LEN + 1]);
+	extern int cache_get(const char *dir, const char *key, int fmt,
+		const char *output);
+	extern int cache_put(const char *dir, const char *key, int fmt,
+		const char *buf, size_t size);
+
+#endif /* CACHE_H */
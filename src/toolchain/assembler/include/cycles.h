@@ -0,0 +1,62 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Davidson Francis <davidsondfgl@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CYCLES_H
+#define CYCLES_H
+
+	/*
+	 * Clock cycles per instruction class, default configuration,
+	 * shared by the listing (tas -l) and the ISS cost models.
+	 */
+
+	/*
+	 * FSM CPU (tangle_cpu.v): every instruction takes FETCH, EXECUTE
+	 * and WRITEBACK, loads wait one more cycle for the memory, stores
+	 * do not (tangle_decode.v) and taken branches refetch.
+	 */
+	#define FSM_STARTUP    2 /* Reset to first instruction.      */
+	#define FSM_AMI        3 /* ALU/Mov.                         */
+	#define FSM_BRA        3 /* Not taken branch.                */
+	#define FSM_BRA_TAKEN  4 /* Taken branch/jump.               */
+	#define FSM_LW         4 /* Load.                            */
+	#define FSM_SW         3 /* Store.                           */
+	#define FSM_SW_HIT     3 /* Store into the next instruction. */
+	#define FSM_SHIFT      3 /* Shift, w/o the shifting cycles.  */
+	#define FSM_NOP        3 /* Unknown opcodes.                 */
+
+	/* Pipelined CPU (tangle_cpu_pipeline.v). */
+	#define PIPE_STARTUP   1
+	#define PIPE_AMI       1
+	#define PIPE_BRA       1
+	#define PIPE_BRA_TAKEN 2
+	#define PIPE_LW        2
+	#define PIPE_SW        2
+	#define PIPE_SW_HIT    2
+	#define PIPE_SHIFT     2
+	#define PIPE_NOP       1
+
+	/* Iterative shifter, extra cycles to shift by @p amt (0-15). */
+	#define SHIFT_CYCLES(amt) (((amt) / 4) + ((amt) % 4))
+
+#endif /* CYCLES_H */
@@ -28,6 +28,7 @@
 	#include <inttypes.h>
 	#include <stdlib.h>
 	#include <sys/types.h>
+	#include "arena.h"
 
 	/**
 	 * @brief Hashtable initial size.
@@ -62,24 +63,34 @@
 
 	/**
 	 * @brief Hashtable linked list structure.
+	 *
+	 * In open addressing hashtables, this is the slot itself
+	 * (stored inline), and 'next' is unused.
 	 */
 	struct list
 	{
 		void *key;          /* Entry key.       */
 		void *value;        /* Entry value.     */
-		uint64_t hash;      /* Entry hash.      */
+		uint64_t hash;      /* Entry full hash. */
 		struct list *next;  /* Entry next list. */
 	};
 
 	/**
 	 * @brief Hashtable structure.
+	 *
+	 * The collision resolution scheme is chosen by the setup
+	 * algorithm: separate chaining (bucket) or open addressing
+	 * with linear probing (slots).
 	 */
 	struct hashtable
 	{
 		struct list **bucket; /* Bucket list.      */
+		struct list *slots;   /* Open addr. slots. */
 		size_t capacity;      /* Current capacity. */
 		size_t elements;      /* Current elements. */
 		ssize_t key_size;     /* Hash key size.    */
+		struct arena *arena;  /* Nodes allocator.  */
+		int open_addressing;  /* Probing or lists. */
 
 #if HASHTABLE_DEBUG
 		size_t collisions;    /* Collisions count. */
@@ -111,6 +122,8 @@
 	);
 	extern int hashtable_iter_next(struct hashtable_iter *it, struct list **li);
 	extern int hashtable_finish(struct hashtable **ht, int dealloc);
+	extern int hashtable_set_arena(struct hashtable **ht,
+		struct arena *arena);
 	extern int hashtable_add(struct hashtable **ht, void *key, void *value);
 	extern void* hashtable_get(struct hashtable **ht, void *key);
 	extern void hashtable_print_stats(struct hashtable **ht);
@@ -118,16 +131,23 @@
 	/* ==================== Hash functions ==================== */
 	extern int hashtable_cmp_ptr(const void *key1, const void *key2);
 
+	extern int hashtable_cmp_string(const void *key1, const void *key2);
+
 	/* sdbm. */
 	extern void hashtable_sdbm_setup(struct hashtable **ht);
+	extern void hashtable_sdbm_oa_setup(struct hashtable **ht);
 	extern uint64_t hashtable_sdbm(const void *key, size_t size);
 
 	/* Splitmix64. */
 	extern void hashtable_splitmix64_setup(struct hashtable **ht);
+	extern void hashtable_splitmix64_oa_setup(struct hashtable **ht);
 	extern uint64_t hashtable_splitmix64_hash(const void *key, size_t size);
 
 	/* MurMur3 Hash. */
 	extern void hashtable_MurMur3_setup(struct hashtable **ht);
+	extern void hashtable_MurMur3_oa_setup(struct hashtable **ht);
 	extern uint64_t hashtable_MurMur3_hash(const void *key, size_t size);
+	extern void hashtable_MurMur3_buffer(const void *key, size_t size,
+		uint64_t seed, uint64_t out[2]);
 
 #endif /* HASHTABLE_H */
@@ -0,0 +1,99 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Davidson Francis <davidsondfgl@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef LIBTAS_H
+#define LIBTAS_H
+
+	#include <stddef.h>
+	#include <stdint.h>
+
+	/**
+	 * Diagnostics callback, called once for each error found.
+	 *
+	 * @param data User data, as passed to the assemble functions.
+	 * @param file Source name.
+	 * @param line Source line, 0 if not related to a line.
+	 * @param msg  Error message, without trailing newline.
+	 */
+	typedef void (*tas_diag_t)(void *data, const char *file, int line,
+		const char *msg);
+
+	/**
+	 * Symbol: a label and the address it was defined at.
+	 */
+	struct tas_symbol
+	{
+		char *name;  /* Label name, NUL-terminated. */
+		size_t addr; /* Label address.              */
+	};
+
+	/**
+	 * Assembled image: one encoded instruction per word,
+	 * indexed by PC.
+	 *
+	 * Each word also has the source line that emitted it (0 for
+	 * padding) and the labels are kept in order of definition.
+	 */
+	struct tas_image
+	{
+		uint16_t *code;          /* Encoded instructions. */
+		size_t size;             /* Amount of words.      */
+		int *lines;              /* Source line, per PC.  */
+		struct tas_symbol *syms; /* Defined labels.       */
+		size_t nsyms;            /* Amount of labels.     */
+	};
+
+	/**
+	 * Output formats.
+	 */
+	enum tas_format
+	{
+		TAS_FMT_HEX,    /* $readmemh text, one word per line. */
+		TAS_FMT_BIN_LE, /* Raw binary, little-endian words.   */
+		TAS_FMT_BIN_BE, /* Raw binary, big-endian words.      */
+		TAS_FMT_IHEX,   /* Intel HEX, byte addressed.         */
+		TAS_FMT_MI      /* Gowin memory initialization file.  */
+	};
+
+	/* External functions. */
+	extern int tas_assemble_buffer(const char *src, size_t size,
+		const char *name, tas_diag_t diag, void *data,
+		struct tas_image *img);
+	extern int tas_assemble_file(const char *file, tas_diag_t diag,
+		void *data, struct tas_image *img);
+	extern int tas_read_file(const char *file, char **buf, size_t *size);
+	extern const char *tas_version(void);
+	extern void tas_image_free(struct tas_image *img);
+	extern int tas_image_fit(struct tas_image *img, size_t mem_size,
+		int pad);
+	extern int tas_format_image(const struct tas_image *img,
+		enum tas_format fmt, const char *name, char **buf, size_t *size);
+	extern int tas_write_buffer(const char *file, const char *buf,
+		size_t size);
+	extern int tas_write_image(const struct tas_image *img,
+		enum tas_format fmt, const char *name, const char *file);
+	extern int tas_write_symbols(const struct tas_image *img,
+		const char *name, const char *file);
+
+#endif /* LIBTAS_H */
@@ -30,31 +30,140 @@
 #ifndef TANGLE_H
 #define TANGLE_H
 	#include <sys/types.h>
-	#include "array.h"
+	#include <stdint.h>
 	#include "hashtable.h"
+	#include "libtas.h"
+	#include "vector.h"
 
 	/*
 	 * Parser configs
 	 */
 
+	/*
+	 * Token, i.e: a view (pointer + length) into the source
+	 * buffer; tokens are never copied nor NUL-terminated.
+	 */
+	struct token
+	{
+		char *str;
+		size_t len;
+	};
+
 	/*
 	 * Instruction.
 	 */
 	struct insn
 	{
-		char *lbl_name;
 		uint16_t insn;
 		uint8_t type;
 		off_t pc;
+		size_t bra;         /* Label branch index. */
+		int relaxed;        /* Long branch form.   */
+		struct token label; /* Long branch target. */
+	};
+
+	/*
+	 * Pending label fixup, i.e: an already emitted instruction
+	 * that references a label not defined yet.
+	 */
+	struct fixup
+	{
+		struct fixup *next;
+		off_t pc;
+		size_t bra;
+		uint8_t type;
+		int line;
 	};
 
 	/*
 	 * Label
+	 *
+	 * Forward referenced labels exist before being defined,
+	 * holding the instructions waiting for them, which are
+	 * backpatched as soon as the label gets defined.
 	 */
 	struct label
 	{
 		off_t off;
-		char *name;
+		struct token name;
+		int defined;
+		struct fixup *pending;
+		struct fixup **pending_end;
+		struct label *next_undef;
+	};
+
+	/*
+	 * Symbol, i.e: a defined label and its address.
+	 */
+	struct symbol
+	{
+		struct token name;
+		off_t off;
+	};
+
+	/* Typed vectors. */
+	VECTOR_DEFINE(code_vec, uint16_t)
+	VECTOR_DEFINE(line_vec, int)
+	VECTOR_DEFINE(sym_vec, struct symbol)
+	VECTOR_DEFINE(relax_vec, uint8_t)
+
+	/*
+	 * Assembler context, i.e: everything needed to assemble
+	 * a single source, so that multiple sources can be
+	 * assembled at the same time.
+	 */
+	struct tas_ctx
+	{
+		/* Source name, for diagnostics. */
+		const char *src_file;
+
+		/* Diagnostics callback. */
+		tas_diag_t diag;
+		void *diag_data;
+
+		/* ASM source buffer. */
+		char *src_buf;
+		size_t src_size;
+		int src_mapped;
+
+		/* Current line and PC. */
+		int current_line;
+		off_t current_pc;
+
+		/* Label table hashtable. */
+		struct hashtable *ht_lbls;
+
+		/* Output: encoded instructions, indexed by PC. */
+		struct code_vec *code_out;
+
+		/* Output: source lines, indexed by PC, and the symbols. */
+		struct line_vec *line_out;
+		struct sym_vec *syms;
+
+		/* Forward referenced labels, in order of appearance. */
+		struct label *undef;
+		struct label **undef_end;
+
+		/* Labels and hashtables nodes allocator. */
+		struct arena *arena;
+
+		/*
+		 * Branch relaxation: one entry per label branch, in source
+		 * order, set if its target is out of the 8-bit range, and
+		 * thus, needs the long form. Kept between passes.
+		 */
+		struct relax_vec *relax;
+		size_t bra_count;
+		int relax_again;
+
+		/*
+		 * Long branches scratch register (.scratch) and, per
+		 * register, the first line that uses it and the first
+		 * long branch that clobbers it, 0 if none.
+		 */
+		int scratch;
+		int reg_line[8];
+		int clobber_line[8];
 	};
 
 	/* Instruction macros, setters. */
@@ -63,6 +172,9 @@
 	#define INSN_SET_RS(i, o)     ((i)->insn |= (((o) & 7) << 5))
 	#define INSN_SET_IMM5(i, o)   ((i)->insn |= ((o)  & 0x1F))
 	#define INSN_SET_IMM8(i, o)   ((i)->insn |= ((o)  & 0xFF))
+	/* Setters, for already emitted (raw) instructions. */
+	#define WORD_SET_IMM5(w, o) ((w) |= ((o) & 0x1F))
+	#define WORD_SET_IMM8(w, o) ((w) |= ((o) & 0xFF))
 	/* Getters. */
 	#define INSN_GET_OPCODE(i) ((i) >> 11)
 
@@ -85,6 +197,8 @@
 	#define MAX_IMM_AMI  ( (1 << IMM_AMI_WIDTH)-1)
 	#define MIN_LOHI_AMI (-(1 << (IMM_LOHI_WIDTH-1)))
 	#define MAX_LOHI_AMI ( (1 << IMM_LOHI_WIDTH)-1)
+	#define MIN_IMM_LI   (-(1 << (INSN_SIZE-1)))
+	#define MAX_IMM_LI   ( (1 << INSN_SIZE)-1)
 
 	/* Instruction table. */
 	struct insn_tbl
@@ -92,7 +206,8 @@
 		char *name;
 		uint8_t opcode;
 		uint8_t type;
-		int (*parser)(char **, struct insn_tbl *, struct insn *);
+		int (*parser)(struct tas_ctx *, char **, const struct insn_tbl *,
+			struct insn *);
 	};
 
 	/*
@@ -103,7 +218,24 @@
 	#define IMM_AMI_WIDTH  5
 	#define IMM_BRA_WIDTH  8
 	#define IMM_LOHI_WIDTH 8
-	#define TOK_SZ        32
+
+	/*
+	 * Memory size (log2, in words), *must* agree with RAM_SIZE_LOG
+	 * in tangle_config.v, may be overridden with RAM_SIZE_LOG=n in
+	 * the make command line.
+	 */
+	#ifndef RAM_SIZE_LOG
+	#define RAM_SIZE_LOG 12
+	#endif
+	#define RAM_SIZE (1 << RAM_SIZE_LOG)
+
+	/*
+	 * Performance counters (ENABLE_PERF_COUNTERS), read-only and
+	 * mapped above the RAM: cycles, retired instructions, memory
+	 * stalls and ALU stalls, 2 words each (low word first).
+	 */
+	#define PERF_BASE 0xFFF0
+	#define PERF_MASK 0xFFF8
 
 	/*
 	 * Tangle opcodes
@@ -153,5 +285,30 @@
 	#define INSN_AMI 0 /* ALU/Memory/IO.  */
 	#define INSN_BRA 1 /* Branch/Jump.    */
 	#define INSN_MEM 2 /* Memory (LW/SW). */
+	#define INSN_PSE 3 /* Pseudo-insn.    */
+
+	/*
+	 * Pseudo-instructions conventions: push/pop use r6 as the
+	 * stack pointer (growing down) and call/ret, r7 as the return
+	 * address (saved by JAL).
+	 */
+	#define REG_SP 6
+	#define REG_RA 7
+
+	/*
+	 * Branch relaxation: branches whose label is out of the 8-bit
+	 * range are rewritten into:
+	 *   j<!cond> $4          # conditional branches only
+	 *   movhi %r5, $hi       # r7 for jal/call
+	 *   movlo %r5, $lo
+	 *   j %r5                # jal %r7 for jal/call
+	 *
+	 * i.e: long branches clobber r5 (JAL always jumps to r7,
+	 * which holds the return address anyway). The '.scratch %rN'
+	 * directive picks another one (r1-r5) from that line onwards,
+	 * and it is an error to use the scratch register of a long
+	 * branch anywhere in the source.
+	 */
+	#define REG_AT 5
 
 #endif /* TANGLE_H */
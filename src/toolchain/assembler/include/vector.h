@@ -0,0 +1,122 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Davidson Francis <davidsondfgl@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef VECTOR_H
+#define VECTOR_H
+
+	#include <stdlib.h>
+
+	/**
+	 * Vector initial size.
+	 */
+	#define VECTOR_DEFAULT_SIZE 16
+
+	/**
+	 * Typed, contiguous, growable vector.
+	 *
+	 * Unlike 'struct array', that only holds pointers, the
+	 * elements are stored by value, so a vector of @p type
+	 * is a plain C array of @p type that grows twice whenever
+	 * it gets full.
+	 *
+	 * VECTOR_DEFINE(name, type) defines 'struct name' and the
+	 * following (static inline) functions:
+	 *
+	 * - int   name_init(struct name **v);
+	 * - int   name_finish(struct name **v);
+	 * - int   name_add(struct name **v, type e);
+	 * - type *name_get(struct name **v, size_t pos);
+	 * - size_t name_size(struct name **v);
+	 *
+	 * which behave like its 'array_*' counterparts.
+	 */
+	#define VECTOR_DEFINE(name, type) \
+		struct name \
+		{ \
+			type *buf; \
+			size_t capacity; \
+			size_t elements; \
+		}; \
+		\
+		static inline int name##_init(struct name **v) \
+		{ \
+			struct name *out; \
+			out = calloc(1, sizeof(struct name)); \
+			if (out == NULL) \
+				return (-1); \
+			out->capacity = VECTOR_DEFAULT_SIZE; \
+			out->buf = malloc(out->capacity * sizeof(type)); \
+			if (out->buf == NULL) \
+			{ \
+				free(out); \
+				return (-1); \
+			} \
+			*v = out; \
+			return (0); \
+		} \
+		\
+		static inline int name##_finish(struct name **v) \
+		{ \
+			if (*v == NULL) \
+				return (-1); \
+			free((*v)->buf); \
+			free(*v); \
+			*v = NULL; \
+			return (0); \
+		} \
+		\
+		static inline int name##_add(struct name **v, type e) \
+		{ \
+			struct name *vec = *v; \
+			type *new_buf; \
+			if (vec == NULL) \
+				return (-1); \
+			if (vec->elements >= vec->capacity) \
+			{ \
+				new_buf = realloc(vec->buf, \
+					(vec->capacity << 1) * sizeof(type)); \
+				if (new_buf == NULL) \
+					return (-1); \
+				vec->buf = new_buf; \
+				vec->capacity <<= 1; \
+			} \
+			vec->buf[vec->elements++] = e; \
+			return (0); \
+		} \
+		\
+		static inline type *name##_get(struct name **v, size_t pos) \
+		{ \
+			if (*v == NULL || pos >= (*v)->elements) \
+				return (NULL); \
+			return (&(*v)->buf[pos]); \
+		} \
+		\
+		static inline size_t name##_size(struct name **v) \
+		{ \
+			if (*v == NULL) \
+				return (0); \
+			return ((*v)->elements); \
+		}
+
+#endif /* VECTOR_H */
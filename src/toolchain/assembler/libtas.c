@@ -0,0 +1,2652 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Davidson Francis <davidsondfgl@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "tas.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define LEX_SIMD
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define LEX_SIMD
+#endif
+
+/*
+ * Code generator version, see tas_version(): bump whenever the
+ * output of a same source may change (encoding, relaxation,
+ * pseudo-instructions or output formats).
+ */
+#define TAS_VERSION "tas-2"
+
+/* Match flags. */
+#define M_NI  0 /* Unconditionally not increment.     */
+#define M_I   1 /* Unconditionally increment.         */
+#define M_IC  2 /* Increment conditionally (if true.) */
+#define M_NS  1 /* Not suppress error msgs.           */
+#define M_S   0 /* Suppress error messages.           */
+
+/* Setters routines. */
+#define S_MATCH    1
+#define S_NOMATCH  0
+#define S_ERROR   -1
+
+/* Register direction: source or destiny. */
+#define S_DIR_RS   0
+#define S_DIR_RD   1
+
+/*
+ * Immediate type: branch, AMI or the high/low label bytes
+ * (MOVHI/MOVLO, li pseudo-instruction only).
+ */
+#define S_TYPE_IMM 0
+#define S_TYPE_BRA 1
+#define S_TYPE_HI  2
+#define S_TYPE_LO  3
+
+/**
+ * Reports an error message and the location from which it
+ * occurred through the context diagnostics callback.
+ *
+ * @param ctx Assembler context.
+ * @param fmt Formatted string to be reported.
+ */
+static void error(struct tas_ctx *ctx, const char* fmt, ...)
+{
+    char msg[1024]; /* Error message. */
+    va_list args;
+    size_t len;
+
+    if (!ctx->diag)
+        return;
+
+    va_start(args, fmt);
+    vsnprintf(msg, sizeof(msg), fmt, args);
+    va_end(args);
+
+    /* Trailing newline is up to the callback. */
+    len = strlen(msg);
+    if (len && msg[len - 1] == '\n')
+        msg[len - 1] = '\0';
+
+    ctx->diag(ctx->diag_data, ctx->src_file, ctx->current_line, msg);
+}
+
+/*
+ * Source padding: the source buffer is always followed by (at
+ * least) SRC_PAD NUL bytes, terminator included, so that the
+ * lexer may read up to 16 bytes at once from any position up
+ * to the terminator.
+ */
+#define SRC_PAD 16
+
+/*
+ * Character classes, see char_class[].
+ *
+ * Note: C_UPPER *must* be 'a' - 'A', so that or'ing the class
+ * into an uppercase letter folds it to lowercase.
+ */
+#define C_BLANK  0x01 /* Space or tab.                */
+#define C_LABEL  0x02 /* Token: [A-Za-z0-9_+-].       */
+#define C_DIGIT  0x04 /* Decimal digit.               */
+#define C_XDIGIT 0x08 /* Hexadecimal digit.           */
+#define C_EOL    0x10 /* End of line: '\n' or '\0'.   */
+#define C_UPPER  0x20 /* Uppercase letter.            */
+
+#define CC_RANGE(c, lo, hi) ((c) >= (lo) && (c) <= (hi))
+#define CC(c) ( \
+	(((c) == ' ' || (c) == '\t') ? C_BLANK : 0) | \
+	((CC_RANGE(c, 'a', 'z') || CC_RANGE(c, 'A', 'Z') || \
+	  CC_RANGE(c, '0', '9') || (c) == '_' || (c) == '-' || \
+	  (c) == '+') ? C_LABEL : 0) | \
+	(CC_RANGE(c, '0', '9') ? C_DIGIT : 0) | \
+	((CC_RANGE(c, '0', '9') || CC_RANGE(c, 'a', 'f') || \
+	  CC_RANGE(c, 'A', 'F')) ? C_XDIGIT : 0) | \
+	(((c) == '\n' || (c) == '\0') ? C_EOL : 0) | \
+	(CC_RANGE(c, 'A', 'Z') ? C_UPPER : 0))
+
+#define CC4(c)   CC(c), CC((c) + 1), CC((c) + 2), CC((c) + 3)
+#define CC16(c)  CC4(c), CC4((c) + 4), CC4((c) + 8), CC4((c) + 12)
+#define CC64(c)  CC16(c), CC16((c) + 16), CC16((c) + 32), CC16((c) + 48)
+
+/*
+ * Character class table, indexed by the (unsigned) character,
+ * so that the lexer does not depend on the locale and needs a
+ * single load per character.
+ */
+static const uint8_t char_class[256] = {
+	CC64(0), CC64(64), CC64(128), CC64(192)
+};
+
+#define CLASS(c) (char_class[(unsigned char)(c)])
+
+#ifdef LEX_SIMD
+/*
+ * SIMD helpers: each one returns the index of the first of the
+ * 16 bytes at @p p that is not in the class, or 16 if all of
+ * them are.
+ */
+#if defined(__SSE2__)
+#define V_LOAD(p)    _mm_loadu_si128((const __m128i *)(p))
+#define V_SET(c)     _mm_set1_epi8((char)(c))
+#define V_EQ(a, b)   _mm_cmpeq_epi8((a), (b))
+#define V_GT(a, b)   _mm_cmpgt_epi8((a), (b))
+#define V_OR(a, b)   _mm_or_si128((a), (b))
+#define V_AND(a, b)  _mm_and_si128((a), (b))
+typedef __m128i vec_t;
+
+static inline int vec_first_zero(vec_t m)
+{
+	unsigned bits = (unsigned)_mm_movemask_epi8(m) ^ 0xFFFF;
+	return (bits ? __builtin_ctz(bits) : 16);
+}
+#else
+#define V_LOAD(p)    vld1q_s8((const int8_t *)(p))
+#define V_SET(c)     vdupq_n_s8((int8_t)(c))
+#define V_EQ(a, b)   vreinterpretq_s8_u8(vceqq_s8((a), (b)))
+#define V_GT(a, b)   vreinterpretq_s8_u8(vcgtq_s8((a), (b)))
+#define V_OR(a, b)   vorrq_s8((a), (b))
+#define V_AND(a, b)  vandq_s8((a), (b))
+typedef int8x16_t vec_t;
+
+static inline int vec_first_zero(vec_t m)
+{
+	uint64_t bits;
+
+	/* 4 bits per byte, inverted. */
+	bits = ~vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(
+		vreinterpretq_u16_s8(m), 4)), 0);
+	return (bits ? __builtin_ctzll(bits) >> 2 : 16);
+}
+#endif
+
+/* Signed ranges, bytes >= 0x80 never match. */
+#define V_RANGE(v, lo, hi) \
+	V_AND(V_GT((v), V_SET((lo) - 1)), V_GT(V_SET((hi) + 1), (v)))
+
+static inline int vec_span_blank(const char *p)
+{
+	vec_t v = V_LOAD(p);
+	return (vec_first_zero(V_OR(V_EQ(v, V_SET(' ')), V_EQ(v, V_SET('\t')))));
+}
+
+static inline int vec_span_label(const char *p)
+{
+	vec_t v = V_LOAD(p);
+	vec_t m;
+
+	m = V_RANGE(V_OR(v, V_SET(0x20)), 'a', 'z');
+	m = V_OR(m, V_RANGE(v, '0', '9'));
+	m = V_OR(m, V_EQ(v, V_SET('_')));
+	m = V_OR(m, V_EQ(v, V_SET('-')));
+	m = V_OR(m, V_EQ(v, V_SET('+')));
+	return (vec_first_zero(m));
+}
+
+static inline int vec_span_line(const char *p)
+{
+	vec_t v = V_LOAD(p);
+	vec_t z = V_SET(0);
+	return (vec_first_zero(V_EQ(V_OR(V_EQ(v, V_SET('\n')), V_EQ(v, z)), z)));
+}
+#endif /* LEX_SIMD */
+
+/**
+ * @brief Check if the parameter @p c is a valid token*.
+ *
+ * @param c Character to be checked.
+ *
+ * @return Returns non-zero if valid or 0 otherwise.
+ *
+ * @note A 'token' can be: label, register or number. This
+ * function have a side effect of allowing labels starting
+ * with '+' or '-', for example, but I do not think this
+ * an issue, a label is just, a label.
+ */
+static inline int is_valid_label(char c)
+{
+	return (CLASS(c) & C_LABEL);
+}
+
+/**
+ * @brief Skips valid characters until there are no more.
+ *
+ * @param s Line pointer.
+ */
+static inline void skip_validlabel(char **s)
+{
+	char *p = *s; /* Current line pointer. */
+#ifdef LEX_SIMD
+	int n;
+	while ((n = vec_span_label(p)) == 16)
+		p += 16;
+	p += n;
+#else
+	while (is_valid_label(*p))
+		p++;
+#endif
+	*s = p;
+}
+
+/**
+ * @brief Skips whitespace (spaces and tabs) characters until
+ * there are no more.
+ *
+ * @param s Line pointer.
+ */
+static inline void skip_whitespace(char **s)
+{
+	char *p = *s; /* Current line pointer. */
+#ifdef LEX_SIMD
+	int n;
+
+	/* Most runs are empty or a single char. */
+	if (!(CLASS(*p) & C_BLANK))
+		return;
+	while ((n = vec_span_blank(p)) == 16)
+		p += 16;
+	p += n;
+#else
+	while (CLASS(*p) & C_BLANK)
+		p++;
+#endif
+	*s = p;
+}
+
+/**
+ * @brief Allocates a new (not defined yet) label @p lbl_name
+ * and adds it into the labels hashtable.
+ *
+ * @param ctx Assembler context.
+ * @param lbl_name Label name.
+ *
+ * @return Returns the new label or NULL if error.
+ *
+ * @note The label name is not copied: it points to the source
+ * buffer, which lives until free_resources().
+ */
+static struct label *new_label(struct tas_ctx *ctx,
+	const struct token *lbl_name)
+{
+	struct label *lbl; /* New label structure. */
+
+	/* Allocate. */
+	if ((lbl = arena_alloc(&ctx->arena, sizeof(struct label))) == NULL)
+	{
+		error(ctx, "failed to allocate new label (%.*s), "
+			"insufficient  memory", (int)lbl_name->len, lbl_name->str);
+		return (NULL);
+	}
+
+	lbl->name        = *lbl_name;
+	lbl->pending_end = &lbl->pending;
+
+	/* Add into the hashtable. */
+	if (hashtable_add(&ctx->ht_lbls, &lbl->name, lbl) < 0)
+	{
+		error(ctx, "failed to insert label (%.*s) into the hashtable\n",
+			(int)lbl_name->len, lbl_name->str);
+		return (NULL);
+	}
+	return (lbl);
+}
+
+/**
+ * @brief Marks the label branch @p bra as out of range: the
+ * whole source is assembled again, with the long form for it.
+ *
+ * Branches only go from the short to the long form, never the
+ * opposite, so the passes stop as soon as all of them fit.
+ *
+ * @param ctx Assembler context.
+ * @param bra Label branch index.
+ *
+ * @return Returns 1 if success and 0 otherwise.
+ */
+static int relax_branch(struct tas_ctx *ctx, size_t bra)
+{
+	while (relax_vec_size(&ctx->relax) <= bra)
+	{
+		if (relax_vec_add(&ctx->relax, 0) < 0)
+		{
+			error(ctx, "unable to relax branch\n");
+			return (0);
+		}
+	}
+
+	*relax_vec_get(&ctx->relax, bra) = 1;
+	ctx->relax_again = 1;
+	return (1);
+}
+
+/**
+ * @brief Fills the immediate of the instruction @p word, at
+ * @p pc, with the (defined) label @p lbl.
+ *
+ * @param ctx Assembler context.
+ * @param type Immediate type: branch (S_TYPE_BRA), AMI
+ *             (S_TYPE_IMM) or label high/low byte (S_TYPE_HI/LO).
+ * @param lbl Label.
+ * @param pc Instruction pc.
+ * @param bra Label branch index (branches only).
+ * @param word Instruction to be filled.
+ *
+ * @return Returns 1 if success and 0 otherwise.
+ */
+static int fill_label(struct tas_ctx *ctx, int type, const struct label *lbl,
+	off_t pc, size_t bra, uint16_t *word)
+{
+	long imm; /* Immediate value. */
+
+	/* Branch. */
+	if (type == S_TYPE_BRA)
+	{
+		imm = (long)(lbl->off - pc);
+
+		/* Out of bounds: use the long form in the next pass. */
+		if (imm < MIN_IMM_BRA || imm > MAX_IMM_BRA)
+			return (relax_branch(ctx, bra));
+
+		/* Fill imm. */
+		WORD_SET_IMM8(*word, imm);
+	}
+
+	/* MOVHI/MOVLO, always fits. */
+	else if (type == S_TYPE_HI)
+		WORD_SET_IMM8(*word, lbl->off >> 8);
+	else if (type == S_TYPE_LO)
+		WORD_SET_IMM8(*word, lbl->off);
+
+	/* AMI. */
+	else
+	{
+		imm = (long)(lbl->off);
+
+		/* Check if out of bounds or not. */
+		if (imm < MIN_IMM_AMI || imm > MAX_IMM_AMI)
+		{
+			error(ctx, "label (%.*s) is too big (%ld) to fit in the register, \n"
+				"valid range: %d to %d\n",
+				(int)lbl->name.len, lbl->name.str, imm, MIN_IMM_AMI,
+				MAX_IMM_AMI);
+			return (0);
+		}
+
+		/* Fill imm. */
+		WORD_SET_IMM5(*word, imm);
+	}
+	return (1);
+}
+
+/**
+ * @brief Records that the instruction at @p pc references the
+ * label @p lbl_name, not defined yet. The label is created
+ * (as undefined), if needed.
+ *
+ * @param ctx Assembler context.
+ * @param lbl Label, if already exists, or NULL.
+ * @param lbl_name Label name.
+ * @param type Immediate type, see fill_label().
+ * @param pc Instruction pc.
+ * @param bra Label branch index, see fill_label().
+ *
+ * @return Returns 1 if success and 0 otherwise.
+ */
+static int add_fixup(struct tas_ctx *ctx, struct label *lbl,
+	const struct token *lbl_name, int type, off_t pc, size_t bra)
+{
+	struct fixup *fixup; /* Pending fixup. */
+
+	if (lbl == NULL)
+	{
+		if ((lbl = new_label(ctx, lbl_name)) == NULL)
+			return (0);
+
+		*ctx->undef_end = lbl;
+		ctx->undef_end  = &lbl->next_undef;
+	}
+
+	if ((fixup = arena_alloc(&ctx->arena, sizeof(struct fixup))) == NULL)
+	{
+		error(ctx, "error while adding label (%.*s) fixup\n",
+			(int)lbl_name->len, lbl_name->str);
+		return (0);
+	}
+
+	fixup->pc   = pc;
+	fixup->bra  = bra;
+	fixup->type = type;
+	fixup->line = ctx->current_line;
+
+	/* Keep the references order. */
+	*lbl->pending_end = fixup;
+	lbl->pending_end  = &fixup->next;
+	return (1);
+}
+
+/**
+ * @brief Adds the label @p lbl_name to the list of labels, as
+ * well as its offset @p off, relative to the program counter.
+ *
+ * All the instructions already waiting for this label are
+ * backpatched here.
+ *
+ * @param lbl_name Label name.
+ * @param off Label offset.
+ *
+ * @return Returns 1 if success and 0 otherwise.
+ */
+static inline int add_label(struct tas_ctx *ctx, struct token *lbl_name,
+	off_t off)
+{
+	struct fixup *fixup; /* Pending fixup.        */
+	struct symbol sym;   /* Symbol entry.         */
+	struct label *lbl;   /* New label structure.  */
+	int line;            /* Definition line.      */
+	int ret;             /* Return code.          */
+
+	/* Check if label already exists. */
+	if ((lbl = hashtable_get(&ctx->ht_lbls, lbl_name)) != NULL &&
+		lbl->defined)
+	{
+		error(ctx, "label (%.*s) is already defined\n",
+			(int)lbl_name->len, lbl_name->str);
+		return (0);
+	}
+
+	if (lbl == NULL && (lbl = new_label(ctx, lbl_name)) == NULL)
+		return (0);
+
+	lbl->off     = off;
+	lbl->defined = 1;
+
+	sym.name = *lbl_name;
+	sym.off  = off;
+	if (sym_vec_add(&ctx->syms, sym) < 0)
+	{
+		error(ctx, "unable to add the symbol (%.*s)\n",
+			(int)lbl_name->len, lbl_name->str);
+		return (0);
+	}
+
+	/* Backpatch, errors are reported at the referencing lines. */
+	ret  = 1;
+	line = ctx->current_line;
+	for (fixup = lbl->pending; fixup; fixup = fixup->next)
+	{
+		ctx->current_line = fixup->line;
+		ret &= fill_label(ctx, fixup->type, lbl, fixup->pc, fixup->bra,
+			code_vec_get(&ctx->code_out, (size_t)fixup->pc));
+	}
+	ctx->current_line = line;
+
+	lbl->pending     = NULL;
+	lbl->pending_end = &lbl->pending;
+	return (ret);
+}
+
+/**
+ * @brief Checks if the (lowercase) character of the string pointed
+ * by @p s is equal to the character @p c.
+ *
+ * @param s String to be checked.
+ * @param c Character to be checked.
+ *
+ * @param inc Increment condition, if M_I, @p s will be increment
+ * regardless the match result; if M_NI no increment will occur and
+ * if M_IC, @p s will be increment if and only if the match occurs.
+ *
+ * @return Returns 1 if the match has occurred and 0 otherwise.
+ */
+static inline int match(struct tas_ctx *ctx, char **s, char c, int inc,
+	int supr)
+{
+	char *p = *s; /* Current line pointer. */
+	int ret = 0;  /* Return code.          */
+
+	if ((unsigned char)(*p | (CLASS(*p) & C_UPPER)) == (unsigned char)c)
+		ret = 1;
+	else
+	{
+		if (supr)
+			error(ctx, "expected '%c', found '%c'\n", c, *p);
+	}
+	/* Increment. */
+	if (inc == M_I)
+		*s = p + 1;
+	else if (inc == M_IC && ret)
+		*s = p + 1;
+	return (ret);
+}
+
+/**
+ * @brief Checks if the (lowercase) character of the string pointed
+ * by @p s is less than the character @p c.
+ *
+ * @param s String to be checked.
+ * @param c Character to be checked.
+ *
+ * @param inc Increment condition, if M_I, @p s will be increment
+ * regardless the match result; if M_NI no increment will occur and
+ * if M_IC, @p s will be increment if and only if the match occurs.
+ *
+ * @return Returns 1 if the match has occurred and 0 otherwise.
+ */
+static inline int match_lt(struct tas_ctx *ctx, char **s, char c, int inc,
+	int supr)
+{
+	char *p = *s; /* Current line pointer. */
+	int ret = 0;  /* Return code.          */
+
+	if (*p < c)
+		ret = 1;
+	else
+	{
+		if (supr)
+			error(ctx, "expected '%c' < '%c'\n", c, *p);
+	}
+	if (inc == M_I)
+		*s = p + 1;
+	else if (inc == M_IC && ret)
+		*s = p + 1;
+	return (ret);
+}
+
+/**
+ * @brief Checks if the (lowercase) character of the string pointed
+ * by @p s is greater than the character @p c.
+ *
+ * @param s String to be checked.
+ * @param c Character to be checked.
+ *
+ * @param inc Increment condition, if M_I, @p s will be increment
+ * regardless the match result; if M_NI no increment will occur and
+ * if M_IC, @p s will be increment if and only if the match occurs.
+ *
+ * @return Returns 1 if the match has occurred and 0 otherwise.
+ */
+static inline int match_gt(struct tas_ctx *ctx, char **s, char c, int inc,
+	int supr)
+{
+	char *p = *s; /* Current line pointer. */
+	int ret = 0;  /* Return code.          */
+
+	if (*p > c)
+		ret = 1;
+	else
+	{
+		if (supr)
+			error(ctx, "expected '%c' > '%c'\n", c, *p);
+	}
+	if (inc == M_I)
+		*s = p + 1;
+	else if (inc == M_IC && ret)
+		*s = p + 1;
+	return (ret);
+}
+
+/**
+ * @brief Reads the next token, i.e: a label or instruction.
+ *
+ * @param line Line pointer.
+ * @param token Output token, pointing into the source buffer.
+ *
+ * @return Returns 1 if success and 0 otherwise.
+ *
+ * @note The parameter @p line will be updated to point
+ * to the next valid character after the token.
+ */
+static inline int read_token(char **line, struct token *token)
+{
+	char *p = *line; /* Current line pointer. */
+
+	token->str = p;
+	skip_validlabel(&p);
+	token->len = (size_t)(p - token->str);
+	skip_whitespace(&p);
+	*line = p;
+
+	return (token->len != 0);
+}
+
+/**
+ * @brief Reads a number (in octal, hexa or decimal) from the
+ * specified line @p s.
+ *
+ * @param s Line pointer.
+ * @param supr Suppress (M_S) or not (M_NS) error messages.
+ *
+ * @return Returns the read number or LONG_MAX if error.
+ *
+ * @note Returning LONG_MAX is not an issue here, because Tangle
+ * do not supports numbers greater than 16-bit, so if a valid
+ * is bigger than this, it will trigger an error anyway.
+ *
+ * The parameter @p s will be updated to point to the next valid
+ * character after the number.
+ */
+static inline long read_number(struct tas_ctx *ctx, char **s, int supr)
+{
+	unsigned long number; /* Number read (magnitude). */
+	unsigned long limit;  /* Max magnitude.           */
+	unsigned base;        /* Number base.             */
+	unsigned d;           /* Current digit.           */
+	char *p = *s;         /* Current line pointer.    */
+	char *digits;         /* First digit.             */
+	int overflow;         /* Out of range.            */
+	int neg;              /* Negative number.         */
+
+	/* Same syntax as strtol(..., 0): [+-](0x<hex>|0<oct>|<dec>). */
+	skip_whitespace(&p);
+	neg = (*p == '-');
+	if (*p == '-' || *p == '+')
+		p++;
+
+	base = 10;
+	if (*p == '0')
+	{
+		base = 8;
+		if ((p[1] | 0x20) == 'x' && (CLASS(p[2]) & C_XDIGIT))
+		{
+			base = 16;
+			p += 2;
+		}
+	}
+
+	limit    = neg ? (unsigned long)LONG_MAX + 1 : LONG_MAX;
+	number   = 0;
+	overflow = 0;
+	for (digits = p; CLASS(*p) & (base == 16 ? C_XDIGIT : C_DIGIT); p++)
+	{
+		d = (CLASS(*p) & C_DIGIT) ? (unsigned)(*p - '0') :
+			(unsigned)((*p | 0x20) - 'a' + 10);
+		if (d >= base)
+			break;
+		if (number > (limit - d) / base)
+			overflow = 1;
+		else
+			number = number * base + d;
+	}
+
+	if (p != digits && !overflow)
+	{
+		*s = p;
+		if (!neg || !number)
+			return ((long)number);
+		/* -LONG_MAX - 1 is not representable as a positive long. */
+		return (-(long)(number - 1) - 1);
+	}
+	if (p != digits)
+		*s = p;
+	if (supr)
+		error(ctx, "invalid number\n");
+
+	return (LONG_MAX);
+}
+
+/**
+ * @brief Token hash function, sdbm over the token bytes.
+ *
+ * @param key Token to be hashed.
+ * @param size Key size (unused here).
+ *
+ * @return Returns a 64-bit hashed number for the @p key argument.
+ */
+static uint64_t token_hash(const void *key, size_t size)
+{
+	const struct token *tok; /* Token.          */
+	uint64_t hash;           /* Resulting hash. */
+	((void)size);
+
+	tok  = key;
+	hash = 0;
+	for (size_t i = 0; i < tok->len; i++)
+	{
+		hash = (unsigned char)tok->str[i] + (hash << 6) +
+			(hash << 16) - hash;
+	}
+	return (hash);
+}
+
+/**
+ * @brief Token comparator.
+ *
+ * @param key1 First token to be compared.
+ * @param key2 Second token to be compared.
+ *
+ * @returns Returns 0 if both tokens are equal and non-zero
+ * otherwise.
+ */
+static int token_cmp(const void *key1, const void *key2)
+{
+	const struct token *t1 = key1; /* First token.  */
+	const struct token *t2 = key2; /* Second token. */
+
+	if (t1->len != t2->len)
+		return (1);
+	return (memcmp(t1->str, t2->str, t1->len));
+}
+
+/**
+ * @brief Setup for the token (label) hashtable.
+ *
+ * Labels may be a lot, so open addressing is used here.
+ *
+ * @param ht Hashtable pointer.
+ */
+static void token_setup(struct hashtable **ht)
+{
+	(*ht)->hash = token_hash;
+	(*ht)->cmp = token_cmp;
+	(*ht)->key_size = sizeof(struct token);
+	(*ht)->open_addressing = 1;
+}
+
+/**
+ * @brief Parses the @p line and sets the destination register
+ * (or source) of the current @p insn instruction according to
+ * the @p direction.
+ *
+ * @param direction If S_DIR_RD, sets the destination register,
+ * and S_DIR_RS sets the source register.
+ *
+ * @param line Current line.
+ * @param insn Current instruction.
+ *
+ * @return Returns S_MATCH if success, S_NOMATCH if the @p line
+ * does not points to a register and S_ERROR if invalid register.
+ *
+ * @note The parameter @p line will be updated to point
+ * to the next valid character after the register.
+ */
+static int set_reg(struct tas_ctx *ctx, int direction, char **line,
+	struct insn *insn)
+{
+	char *p = *line; /* Current line pointer. */
+	int reg;         /* Register number.      */
+
+	if (match(ctx, &p, '%', M_IC, M_S))
+	{
+		if (match(ctx, &p, 'r', M_IC, M_NS))
+		{
+			if (match_lt(ctx, &p, '0', M_NI, M_S) ||
+				match_gt(ctx, &p, '7', M_I, M_S))
+				return (S_ERROR);
+
+			/* Long branches scratch register check. */
+			reg = *(p - 1) - '0';
+			if (!ctx->reg_line[reg])
+				ctx->reg_line[reg] = ctx->current_line;
+
+			if (direction)
+			{
+				INSN_SET_RD(insn, reg);
+			}
+
+			/*
+			 * MOVHI and MOVLO cannot have a register in the second
+			 * operand, so we want to make sure that first.
+			 */
+			else if (INSN_GET_OPCODE(insn->insn) != OPC_MOVHI &&
+				INSN_GET_OPCODE(insn->insn) != OPC_MOVLO)
+			{
+				INSN_SET_RS(insn, reg);
+			}
+			else
+				return (S_ERROR);
+		}
+		else
+			return (S_ERROR);
+	}
+	else
+		return (S_NOMATCH);
+
+	*line = p;
+	return (S_MATCH);
+}
+
+/**
+ * @brief Parses the @p line and sets the immediate value of the
+ * current @p insn instruction accordingly to the type @p type
+ * (if branch or AMI).
+ *
+ * @param type Indicates if the instruction is branch (S_TYPE_BRA)
+ * or AMI (S_TYPE_AMI). This is needed because the immediate value
+ * size is different for both kind of instructions: 5-bits for AMI
+ * and 8-bits for branch.
+ *
+ * @param line Current line.
+ * @param insn Current instruction.
+ *
+ * @return Returns S_MATCH if success, S_NOMATCH if the @p line
+ * does not points to a number and S_ERROR if invalid number.
+ *
+ * @note The parameter @p line will be updated to point to the
+ * next valid character after the immediate.
+ */
+static int set_imm(struct tas_ctx *ctx, int type, char **line,
+	const struct insn_tbl *tbl, struct insn *insn)
+{
+	char *p = *line; /* Current line pointer. */
+	long imm;        /* Immediate value.      */
+
+	if (match(ctx, &p, '$', M_IC, M_S))
+	{
+		if (type == S_TYPE_BRA)
+		{
+			/*
+			 * Single operand instructions only allows immediate values
+			 * inside branches, so we need to ensure that first.
+			 */
+			if (tbl->type != INSN_BRA)
+			{
+				error(ctx, "in single-operand instructions, immediate values are only\n"
+					"allowed inside branches!\n");
+				return (S_ERROR);
+			}
+
+			imm = read_number(ctx, &p, M_NS);
+
+			/* Check if valid number and range. */
+			if (imm == LONG_MAX || imm < MIN_IMM_BRA || imm > MAX_IMM_BRA)
+			{
+				error(ctx, "invalid number or out-of-range (expects: %d -- %d)\n",
+					MIN_IMM_BRA, MAX_IMM_BRA);
+				return (S_ERROR);
+			}
+
+			/* Fill imm. */
+			INSN_SET_IMM8(insn, imm);
+		}
+
+		else
+		{
+			imm = read_number(ctx, &p, M_NS);
+
+			/* MOVHI and MOVLO exceptions. */
+			if (INSN_GET_OPCODE(insn->insn) != OPC_MOVHI &&
+				INSN_GET_OPCODE(insn->insn) != OPC_MOVLO)
+			{
+				/* Check if valid number and range. */
+				if (imm == LONG_MAX || imm < MIN_IMM_AMI || imm > MAX_IMM_AMI)
+				{
+					error(ctx, "invalid number or out-of-range (expects: %d -- %d)\n",
+						MIN_IMM_AMI, MAX_IMM_AMI);
+					return (S_ERROR);
+				}
+
+				/* Fill imm. */
+				INSN_SET_IMM5(insn, imm);
+			}
+
+			else
+			{
+				/* Check if valid number and range. */
+				if (imm == LONG_MAX || imm < MIN_LOHI_AMI || imm > MAX_LOHI_AMI)
+				{
+					error(ctx, "invalid number or out-of-range (expects: %d -- %d)\n",
+						MIN_LOHI_AMI, MAX_LOHI_AMI);
+					return (S_ERROR);
+				}
+
+				/* Fill imm. */
+				INSN_SET_IMM8(insn, imm);
+			}
+		}
+	}
+	else
+		return (S_NOMATCH);
+
+	*line = p;
+	return (S_MATCH);
+}
+
+/**
+ * @brief Fills the immediate of @p insn with the label @p tok,
+ * right away if already defined (backward reference), or as
+ * soon as it gets defined (forward reference).
+ *
+ * @param type Immediate type, see fill_label().
+ * @param tok Label name.
+ * @param insn Current instruction.
+ *
+ * @return Returns 1 if success and 0 otherwise.
+ */
+static int resolve_label(struct tas_ctx *ctx, int type,
+	struct token *tok, struct insn *insn)
+{
+	struct label *lbl; /* Label, if exists. */
+
+	/* Backward reference: resolve right away. */
+	lbl = hashtable_get(&ctx->ht_lbls, tok);
+	if (lbl != NULL && lbl->defined)
+		return (fill_label(ctx, type, lbl, insn->pc, insn->bra, &insn->insn));
+
+	/* Forward reference: wait for the label definition. */
+	return (add_fixup(ctx, lbl, tok, type, insn->pc, insn->bra));
+}
+
+/**
+ * @brief Parses the @p line and sets (or not*) the label of the
+ * current @p insn instruction accordingly to the type @p type
+ * (if branch or AMI).
+ *
+ * @param type Indicates if the instruction is branch (S_TYPE_BRA)
+ * or AMI (S_TYPE_AMI). This is needed because the label for a
+ * branch instruction is relative to the current PC, while for an
+ * AMI instruction, the label is the absolute value. Besides that,
+ * the sizes are different: 8-bits for branches and 5-bits for AMI
+ * instructions.
+ *
+ * @param line Current line.
+ * @param insn Current instruction.
+ *
+ * @return Returns 1 if success and 0 otherwise.
+ *
+ * @note The parameter @p line will be updated to point the next
+ * valid character after the label.
+ */
+static int set_label(struct tas_ctx *ctx, int type, char **line,
+	const struct insn_tbl *tbl, struct insn *insn)
+{
+	struct token tok;  /* Label name.           */
+	char *p = *line;   /* Current line pointer. */
+
+	if (type == S_TYPE_BRA)
+	{
+		/*
+		 * Single operand instructions only allows labels inside
+		 * branches, so we need to ensure that first.
+		 */
+		if (tbl->type != INSN_BRA)
+		{
+			error(ctx, "in single-operand instructions, labels are only\n"
+				"allowed inside branches!\n");
+			return (0);
+		}
+	}
+
+	/* MOVHI and MOVLO do not handle labels at the moment. */
+	else if (INSN_GET_OPCODE(insn->insn) == OPC_MOVHI ||
+		INSN_GET_OPCODE(insn->insn) == OPC_MOVLO)
+	{
+		return (0);
+	}
+
+	/* Read label. */
+	if (!read_token(&p, &tok))
+		return (0);
+
+	/*
+	 * Branches already known to be out of range: the long
+	 * form is emitted by emit_insn().
+	 */
+	if (type == S_TYPE_BRA)
+	{
+		insn->bra = ctx->bra_count++;
+		if (insn->bra < relax_vec_size(&ctx->relax) &&
+			*relax_vec_get(&ctx->relax, insn->bra))
+		{
+			insn->relaxed = 1;
+			insn->label   = tok;
+			*line = p;
+			return (1);
+		}
+	}
+
+	if (!resolve_label(ctx, type, &tok, insn))
+		return (0);
+
+	*line = p;
+	return (1);
+}
+
+/**
+ * @brief Reads the first operand of the current instruction
+ * and sets the destination register properly.
+ *
+ * @param line Current line.
+ * @param tbl Instruction table entry.
+ * @param insn Current instruction.
+ *
+ * @return Returns 1 if success and 0 otherwise.
+ *
+ * @note The parameter @p line will be updated to point
+ * to the next valid character after the first operand.
+ */
+static int read_first_operand(struct tas_ctx *ctx, char **line,
+	const struct insn_tbl *tbl, struct insn *insn)
+{
+	/* Reg Dest. */
+	if (set_reg(ctx, S_DIR_RD, line, insn) != S_MATCH)
+	{
+		error(ctx, "first operand of instruction '%s' is invalid!\n",
+			tbl->name);
+		return (0);
+	}
+	return (1);
+}
+
+/**
+ * @brief Reads the second operand of the current instruction
+ * and sets the destination register or the immediate value
+ * properly.
+ *
+ * @param line Current line.
+ * @param tbl Instructon table entry.
+ * @param insn Current instruction.
+ *
+ * @return Returns 1 if success and 0 otherwise.
+ *
+ * @note The parameter @p line will be updated to point
+ * to the next valid character after the register.
+ *
+ * Also note that the second operand can be: register,
+ * immediate value and/or a label.
+ */
+static int read_second_operand(struct tas_ctx *ctx, char **line,
+	const struct insn_tbl *tbl, struct insn *insn)
+{
+	int set; /* Return code. */
+
+	if (!match(ctx, line, ',', M_I, M_NS))
+		goto err;
+
+	skip_whitespace(line);
+
+	/* If Reg/Reg. */
+	if ((set = set_reg(ctx, S_DIR_RS, line, insn)) != S_NOMATCH)
+	{
+		if (set == S_ERROR)
+			goto err;
+	}
+
+	/* Reg/Imm. */
+	else if ((set = set_imm(ctx, S_TYPE_IMM, line, tbl, insn)) != S_NOMATCH)
+	{
+		if (set == S_ERROR)
+			goto err;
+	}
+
+	/* Reg/Label. */
+	else if (!set_label(ctx, S_TYPE_IMM, line, tbl, insn))
+		goto err;
+
+	/* Check if ok. */
+	skip_whitespace(line);
+
+	if (!match(ctx, line, '#',  M_NI, M_S) &&
+		!match(ctx, line, ';',  M_IC, M_S) &&
+		!match(ctx, line, '\n', M_NI, M_S) &&
+		!match(ctx, line, '\0', M_NI, M_S))
+	{
+		goto err;
+	}
+
+	return (1);
+err:
+	error(ctx, "second operand of instruction '%s' is invalid!\n",
+		tbl->name);
+	return (0);
+}
+
+/**
+ * @brief Parses instructions that have three operands; at the
+ * moment, only lw and sw fits in this category.
+ *
+ * @param line Current line.
+ * @param tbl Instructon table entry.
+ * @param insn Current instruction.
+ *
+ * @return Returns 1 if success and 0 otherwise.
+ *
+ * @note The parameter @p line will be updated to point
+ * to the next valid character after the register.
+ *
+ * Note that sw/lw has a specific (and strict) format that
+ * differs from instructions with one or two operands, and thus
+ * the parser is slightly different from the first two.
+ */
+static int parse_three_params(struct tas_ctx *ctx, char **line,
+	const struct insn_tbl *tbl, struct insn *insn)
+{
+	char *p = *line; /* Current line pointer. */
+
+	/* Fill opcode. */
+	INSN_SET_OPCODE(insn, tbl->opcode);
+	insn->type = tbl->type;
+	insn->pc = ctx->current_pc;
+
+	/* Read operands. */
+	if (!read_first_operand(ctx, &p, tbl, insn))
+	{
+		error(ctx, "first operand needs to be a valid register!\n");
+		goto err;
+	}
+
+	skip_whitespace(&p);
+
+	if (!match(ctx, &p, ',', M_I, M_NS))
+		goto err;
+
+	skip_whitespace(&p);
+
+	if (set_imm(ctx, S_TYPE_IMM, &p, tbl, insn) != S_MATCH)
+	{
+		error(ctx, "second operand needs to be a valid number!\n");
+		goto err;
+	}
+
+	skip_whitespace(&p);
+
+	if (!match(ctx, &p, '(', M_I, M_NS))
+		goto err;
+
+	skip_whitespace(&p);
+
+	if (set_reg(ctx, S_DIR_RS, &p, insn) != S_MATCH)
+	{
+		error(ctx, "third operand needs to be a valid register!\n");
+		goto err;
+	}
+
+	skip_whitespace(&p);
+
+	if (!match(ctx, &p, ')', M_I, M_NS))
+		goto err;
+
+	/* Check if ok. */
+	skip_whitespace(&p);
+
+	if (!match(ctx, &p, '#',  M_NI, M_S) &&
+		!match(ctx, &p, ';',  M_IC, M_S) &&
+		!match(ctx, &p, '\n', M_NI, M_S) &&
+		!match(ctx, &p, '\0', M_NI, M_S))
+	{
+		goto err;
+	}
+
+	/* Update the pointer. */
+	*line = p;
+	return (1);
+err:
+	return (0);
+}
+
+/**
+ * @brief Parses instructions that have two operands; at the
+ * moment, only AMI instructions fall into this category.
+ *
+ * @param line Current line.
+ * @param tbl Instructon table entry.
+ * @param insn Current instruction.
+ *
+ * @return Returns 1 if success and 0 otherwise.
+ *
+ * @note The parameter @p line will be updated to point
+ * to the next valid character after the register.
+ */
+static int parse_two_params(struct tas_ctx *ctx, char **line,
+	const struct insn_tbl *tbl, struct insn *insn)
+{
+	char *p = *line; /* Current line pointer. */
+
+	/* Fill opcode. */
+	INSN_SET_OPCODE(insn, tbl->opcode);
+	insn->type = tbl->type;
+	insn->pc = ctx->current_pc;
+
+	/* Read operands. */
+	if (!read_first_operand(ctx, &p, tbl, insn))
+		return (0);
+
+	skip_whitespace(&p);
+
+	if (!read_second_operand(ctx, &p, tbl, insn))
+		return (0);
+
+	/* Update the pointer. */
+	*line = p;
+	return (1);
+}
+
+/**
+ * @brief Parses instructions that have one operand; at the
+ * moment, AMI and branches instructions.
+ *
+ * @param line Current line.
+ * @param tbl Instructon table entry.
+ * @param insn Current instruction.
+ *
+ * @return Returns 1 if success and 0 otherwise.
+ *
+ * @note The parameter @p line will be updated to point
+ * to the next valid character after the register.
+ */
+static int parse_one_param(struct tas_ctx *ctx, char **line,
+	const struct insn_tbl *tbl, struct insn *insn)
+{
+	char *p = *line; /* Current line pointer. */
+	int set;         /* Return code.          */
+
+	/* Fill opcode. */
+	INSN_SET_OPCODE(insn, tbl->opcode);
+	insn->type = tbl->type;
+	insn->pc = ctx->current_pc;
+
+	/* If Reg/Reg. */
+	if ((set = set_reg(ctx, S_DIR_RD, &p, insn)) != S_NOMATCH)
+	{
+		if (set == S_ERROR)
+			goto err;
+	}
+
+	/* Reg/Imm. */
+	else if ((set = set_imm(ctx, S_TYPE_BRA, &p, tbl, insn)) != S_NOMATCH)
+	{
+		if (set == S_ERROR)
+			goto err;
+	}
+
+	/* Reg/Label. */
+	else if (!set_label(ctx, S_TYPE_BRA, &p, tbl, insn))
+		goto err;
+
+	/* Check if ok. */
+	skip_whitespace(&p);
+
+	if (!match(ctx, &p, '#',  M_NI, M_S) &&
+		!match(ctx, &p, ';',  M_IC, M_S) &&
+		!match(ctx, &p, '\n', M_NI, M_S) &&
+		!match(ctx, &p, '\0', M_NI, M_S))
+	{
+		goto err;
+	}
+
+	/* Update the pointer. */
+	*line = p;
+	return (1);
+
+err:
+	error(ctx, "error while parsing single operand\n");
+	return (0);
+}
+
+/**
+ * @brief Parses instructions that do not have any operands;
+ * such as nop and halt (to be implemented).
+ *
+ * @param line Current line.
+ * @param tbl Instructon table entry.
+ * @param insn Current instruction.
+ *
+ * @return Returns 1 if success and 0 otherwise.
+ *
+ * @note The parameter @p line will be updated to point
+ * to the next valid character after the register.
+ */
+static int parse_no_param(struct tas_ctx *ctx, char **line,
+	const struct insn_tbl *tbl, struct insn *insn)
+{
+	((void)line);
+
+	/* Fill opcode. */
+	INSN_SET_OPCODE(insn, tbl->opcode);
+	insn->type = tbl->type;
+	insn->pc = ctx->current_pc;
+
+	return (1);
+}
+
+/* Pseudo-instructions parsers. */
+static int parse_li(struct tas_ctx *ctx, char **line,
+	const struct insn_tbl *tbl, struct insn *insn);
+static int parse_call(struct tas_ctx *ctx, char **line,
+	const struct insn_tbl *tbl, struct insn *insn);
+static int parse_ret(struct tas_ctx *ctx, char **line,
+	const struct insn_tbl *tbl, struct insn *insn);
+static int parse_push(struct tas_ctx *ctx, char **line,
+	const struct insn_tbl *tbl, struct insn *insn);
+static int parse_pop(struct tas_ctx *ctx, char **line,
+	const struct insn_tbl *tbl, struct insn *insn);
+
+/* Instruction table indexes. */
+enum insn_idx
+{
+	I_OR,
+	I_AND,
+	I_XOR,
+	I_SLL,
+	I_SLR,
+	I_NOT,
+	I_NEG,
+	I_ADD,
+	I_SUB,
+	I_CMP,
+	I_MOV,
+	I_MOVHI,
+	I_MOVLO,
+	I_J,
+	I_JAL,
+	I_JE,
+	I_JNE,
+	I_JGS,
+	I_JGU,
+	I_JLS,
+	I_JLU,
+	I_JGES,
+	I_JGEU,
+	I_JLES,
+	I_JLEU,
+	I_LW,
+	I_SW,
+	I_NOP,
+	I_LI,
+	I_CALL,
+	I_RET,
+	I_PUSH,
+	I_POP,
+	I_COUNT
+};
+
+/* Instruction table. */
+static const struct insn_tbl insn_tbl[I_COUNT] ={
+	/* Logical. */
+	[I_OR] =    {.name = "or",  .opcode = OPC_OR , .type = INSN_AMI, .parser = parse_two_params},
+	[I_AND] =   {.name = "and", .opcode = OPC_AND, .type = INSN_AMI, .parser = parse_two_params},
+	[I_XOR] =   {.name = "xor", .opcode = OPC_XOR, .type = INSN_AMI, .parser = parse_two_params},
+	[I_SLL] =   {.name = "sll", .opcode = OPC_SLL, .type = INSN_AMI, .parser = parse_two_params},
+	[I_SLR] =   {.name = "slr", .opcode = OPC_SLR, .type = INSN_AMI, .parser = parse_two_params},
+	[I_NOT] =   {.name = "not", .opcode = OPC_NOT, .type = INSN_AMI, .parser = parse_one_param},
+	[I_NEG] =   {.name = "neg", .opcode = OPC_NEG, .type = INSN_AMI, .parser = parse_one_param},
+
+	/* Arithmetic. */
+	[I_ADD] =   {.name = "add", .opcode = OPC_ADD, .type = INSN_AMI, .parser = parse_two_params},
+	[I_SUB] =   {.name = "sub", .opcode = OPC_SUB, .type = INSN_AMI, .parser = parse_two_params},
+	[I_CMP] =   {.name = "cmp", .opcode = OPC_CMP, .type = INSN_AMI, .parser = parse_two_params},
+
+	/* Move. */
+	[I_MOV] =   {.name = "mov",   .opcode = OPC_MOV,   .type = INSN_AMI, .parser = parse_two_params},
+	[I_MOVHI] = {.name = "movhi", .opcode = OPC_MOVHI, .type = INSN_AMI, .parser = parse_two_params},
+	[I_MOVLO] = {.name = "movlo", .opcode = OPC_MOVLO, .type = INSN_AMI, .parser = parse_two_params},
+
+	/* Branch. */
+	[I_J] =     {.name = "j",   .opcode = OPC_J,   .type = INSN_BRA, .parser = parse_one_param},
+	[I_JAL] =   {.name = "jal", .opcode = OPC_JAL, .type = INSN_BRA, .parser = parse_one_param},
+	[I_JE] =    {.name = "je",  .opcode = OPC_JE,  .type = INSN_BRA, .parser = parse_one_param},
+	[I_JNE] =   {.name = "jne", .opcode = OPC_JNE, .type = INSN_BRA, .parser = parse_one_param},
+
+	[I_JGS] =   {.name = "jgs", .opcode = OPC_JGS, .type = INSN_BRA, .parser = parse_one_param},
+	[I_JGU] =   {.name = "jgu", .opcode = OPC_JGU, .type = INSN_BRA, .parser = parse_one_param},
+	[I_JLS] =   {.name = "jls", .opcode = OPC_JLS, .type = INSN_BRA, .parser = parse_one_param},
+	[I_JLU] =   {.name = "jlu", .opcode = OPC_JLU, .type = INSN_BRA, .parser = parse_one_param},
+
+	[I_JGES] =  {.name = "jges", .opcode = OPC_JGES, .type = INSN_BRA, .parser = parse_one_param},
+	[I_JGEU] =  {.name = "jgeu", .opcode = OPC_JGEU, .type = INSN_BRA, .parser = parse_one_param},
+	[I_JLES] =  {.name = "jles", .opcode = OPC_JLES, .type = INSN_BRA, .parser = parse_one_param},
+	[I_JLEU] =  {.name = "jleu", .opcode = OPC_JLEU, .type = INSN_BRA, .parser = parse_one_param},
+
+	/* Memory. */
+	[I_LW] =    {.name = "lw", .opcode = OPC_LW, .type = INSN_MEM, .parser = parse_three_params},
+	[I_SW] =    {.name = "sw", .opcode = OPC_SW, .type = INSN_MEM, .parser = parse_three_params},
+
+	/* Misc. */
+	[I_NOP] =   {.name = "nop", .opcode = OPC_NEG, .type = INSN_AMI, .parser = parse_no_param},
+
+	/* Pseudo-instructions, emit their own instructions. */
+	[I_LI] =    {.name = "li",   .opcode = OPC_MOV, .type = INSN_PSE, .parser = parse_li},
+	[I_CALL] =  {.name = "call", .opcode = OPC_JAL, .type = INSN_PSE, .parser = parse_call},
+	[I_RET] =   {.name = "ret",  .opcode = OPC_J,   .type = INSN_PSE, .parser = parse_ret},
+	[I_PUSH] =  {.name = "push", .opcode = OPC_SW,  .type = INSN_PSE, .parser = parse_push},
+	[I_POP] =   {.name = "pop",  .opcode = OPC_LW,  .type = INSN_PSE, .parser = parse_pop}
+};
+
+/* Packs up to 4 mnemonic (lowercase) characters into an integer. */
+#define MN1(a)       ((uint32_t)(a))
+#define MN2(a,b)     ((MN1(a)       << 8) | (uint32_t)(b))
+#define MN3(a,b,c)   ((MN2(a,b)     << 8) | (uint32_t)(c))
+#define MN4(a,b,c,d) ((MN3(a,b,c)   << 8) | (uint32_t)(d))
+
+/*
+ * Lowercase for mnemonic characters: since mnemonics only have
+ * letters and label characters do not map into letters, setting
+ * bit 5 is enough.
+ */
+#define MN_LOWER(c) ((uint32_t)((unsigned char)(c) | 0x20))
+
+/**
+ * @brief Finds the instruction table entry of the mnemonic
+ * @p tok, case insensitive.
+ *
+ * Since the mnemonic set is fixed and tiny, this works as a
+ * perfect hash: the first four lowercase characters are packed
+ * into an integer, which uniquely identifies each mnemonic up to
+ * four characters long, and the switch below resolves it with
+ * neither a runtime table nor a separate lowercase pass. Five
+ * characters mnemonics (movhi/movlo) only check the last one.
+ *
+ * @param tok Mnemonic token.
+ *
+ * @return Returns the instruction table entry or NULL if
+ * not found.
+ *
+ * @note New instruction table entries must be added here too.
+ */
+static const struct insn_tbl *find_insn(const struct token *tok)
+{
+	uint32_t key; /* Packed mnemonic. */
+	size_t len;   /* Packed length.   */
+
+	if (tok->len < 1 || tok->len > 5)
+		return (NULL);
+
+	key = 0;
+	len = tok->len < 4 ? tok->len : 4;
+	for (size_t i = 0; i < len; i++)
+		key = (key << 8) | MN_LOWER(tok->str[i]);
+
+	/* Five characters. */
+	if (tok->len == 5)
+	{
+		if (key != MN4('m','o','v','h') && key != MN4('m','o','v','l'))
+			return (NULL);
+		if (key == MN4('m','o','v','h') && MN_LOWER(tok->str[4]) == 'i')
+			return (&insn_tbl[I_MOVHI]);
+		if (key == MN4('m','o','v','l') && MN_LOWER(tok->str[4]) == 'o')
+			return (&insn_tbl[I_MOVLO]);
+		return (NULL);
+	}
+
+	switch (key)
+	{
+		/* Logical. */
+		case MN2('o','r'):     return (&insn_tbl[I_OR]);
+		case MN3('a','n','d'): return (&insn_tbl[I_AND]);
+		case MN3('x','o','r'): return (&insn_tbl[I_XOR]);
+		case MN3('s','l','l'): return (&insn_tbl[I_SLL]);
+		case MN3('s','l','r'): return (&insn_tbl[I_SLR]);
+		case MN3('n','o','t'): return (&insn_tbl[I_NOT]);
+		case MN3('n','e','g'): return (&insn_tbl[I_NEG]);
+
+		/* Arithmetic. */
+		case MN3('a','d','d'): return (&insn_tbl[I_ADD]);
+		case MN3('s','u','b'): return (&insn_tbl[I_SUB]);
+		case MN3('c','m','p'): return (&insn_tbl[I_CMP]);
+
+		/* Move. */
+		case MN3('m','o','v'): return (&insn_tbl[I_MOV]);
+
+		/* Branch. */
+		case MN1('j'):         return (&insn_tbl[I_J]);
+		case MN3('j','a','l'): return (&insn_tbl[I_JAL]);
+		case MN2('j','e'):     return (&insn_tbl[I_JE]);
+		case MN3('j','n','e'): return (&insn_tbl[I_JNE]);
+
+		case MN3('j','g','s'): return (&insn_tbl[I_JGS]);
+		case MN3('j','g','u'): return (&insn_tbl[I_JGU]);
+		case MN3('j','l','s'): return (&insn_tbl[I_JLS]);
+		case MN3('j','l','u'): return (&insn_tbl[I_JLU]);
+
+		case MN4('j','g','e','s'): return (&insn_tbl[I_JGES]);
+		case MN4('j','g','e','u'): return (&insn_tbl[I_JGEU]);
+		case MN4('j','l','e','s'): return (&insn_tbl[I_JLES]);
+		case MN4('j','l','e','u'): return (&insn_tbl[I_JLEU]);
+
+		/* Memory. */
+		case MN2('l','w'):     return (&insn_tbl[I_LW]);
+		case MN2('s','w'):     return (&insn_tbl[I_SW]);
+
+		/* Misc. */
+		case MN3('n','o','p'): return (&insn_tbl[I_NOP]);
+
+		/* Pseudo-instructions. */
+		case MN2('l','i'):         return (&insn_tbl[I_LI]);
+		case MN4('c','a','l','l'): return (&insn_tbl[I_CALL]);
+		case MN3('r','e','t'):     return (&insn_tbl[I_RET]);
+		case MN4('p','u','s','h'): return (&insn_tbl[I_PUSH]);
+		case MN3('p','o','p'):     return (&insn_tbl[I_POP]);
+	}
+	return (NULL);
+}
+
+/**
+ * @brief Adds the instruction @p word into the output, at the
+ * current PC, and advances it.
+ *
+ * @param word Encoded instruction.
+ *
+ * @return Returns 1 if success and 0 otherwise.
+ */
+static int emit_word(struct tas_ctx *ctx, uint16_t word)
+{
+	if (code_vec_add(&ctx->code_out, word) < 0 ||
+		line_vec_add(&ctx->line_out, ctx->current_line) < 0)
+	{
+		error(ctx, "error while adding processed instruction: %x\n",
+			word);
+		return (0);
+	}
+
+	ctx->current_pc += (INSN_SIZE/BYTE_SIZE);
+	return (1);
+}
+
+/**
+ * @brief Inverts the condition of the branch opcode @p opc.
+ *
+ * @param opc Conditional branch opcode.
+ *
+ * @return Returns the opcode of the opposite condition.
+ */
+static int invert_branch(int opc)
+{
+	switch (opc)
+	{
+		case OPC_JE:   return (OPC_JNE);
+		case OPC_JNE:  return (OPC_JE);
+		case OPC_JGS:  return (OPC_JLES);
+		case OPC_JLES: return (OPC_JGS);
+		case OPC_JGU:  return (OPC_JLEU);
+		case OPC_JLEU: return (OPC_JGU);
+		case OPC_JLS:  return (OPC_JGES);
+		case OPC_JGES: return (OPC_JLS);
+		case OPC_JLU:  return (OPC_JGEU);
+		case OPC_JGEU: return (OPC_JLU);
+	}
+
+	/* Not reached: only conditional branches are inverted. */
+	return (opc);
+}
+
+/**
+ * @brief Adds the parsed instruction @p insn into the output;
+ * long (relaxed) branches are expanded here, see REG_AT.
+ *
+ * @param insn Parsed instruction.
+ *
+ * @return Returns 1 if success and 0 otherwise.
+ */
+static int emit_insn(struct tas_ctx *ctx, struct insn *insn)
+{
+	struct insn hi; /* MOVHI.           */
+	struct insn lo; /* MOVLO.           */
+	uint16_t jump;  /* Register jump.   */
+	int opc;        /* Branch opcode.   */
+	int reg;        /* Target register. */
+
+	if (!insn->relaxed)
+		return (emit_word(ctx, insn->insn));
+
+	opc = INSN_GET_OPCODE(insn->insn);
+	reg = opc == OPC_JAL ? REG_RA : ctx->scratch;
+	if (opc != OPC_JAL && !ctx->clobber_line[reg])
+		ctx->clobber_line[reg] = ctx->current_line;
+
+	/* Conditional: skips the long jump if not taken. */
+	if (opc != OPC_J && opc != OPC_JAL)
+	{
+		if (!emit_word(ctx, (uint16_t)(invert_branch(opc) << 11) | 4))
+			return (0);
+	}
+
+	memset(&hi, 0, sizeof(hi));
+	memset(&lo, 0, sizeof(lo));
+	INSN_SET_OPCODE(&hi, OPC_MOVHI);
+	INSN_SET_RD(&hi, reg);
+	INSN_SET_OPCODE(&lo, OPC_MOVLO);
+	INSN_SET_RD(&lo, reg);
+	hi.pc = ctx->current_pc;
+	lo.pc = ctx->current_pc + 1;
+
+	if (!resolve_label(ctx, S_TYPE_HI, &insn->label, &hi) ||
+		!resolve_label(ctx, S_TYPE_LO, &insn->label, &lo))
+	{
+		return (0);
+	}
+
+	/* JAL w/ register always jumps to r7. */
+	jump = (uint16_t)(((opc == OPC_JAL ? OPC_JAL : OPC_J) << 11) |
+		(reg << 8));
+
+	return (emit_word(ctx, hi.insn) && emit_word(ctx, lo.insn) &&
+		emit_word(ctx, jump));
+}
+
+/**
+ * @brief Checks that nothing but a comment follows the
+ * current (pseudo) instruction.
+ *
+ * @param line Current line.
+ *
+ * @return Returns 1 if success and 0 otherwise.
+ */
+static int check_eol(struct tas_ctx *ctx, char **line)
+{
+	skip_whitespace(line);
+
+	if (!match(ctx, line, '#',  M_NI, M_S) &&
+		!match(ctx, line, ';',  M_IC, M_S) &&
+		!match(ctx, line, '\n', M_NI, M_S) &&
+		!match(ctx, line, '\0', M_NI, M_S))
+	{
+		return (0);
+	}
+	return (1);
+}
+
+/**
+ * @brief Parses the li (load immediate) pseudo-instruction:
+ * li %rd, $imm16 (or label).
+ *
+ * Immediates expand to the shortest sequence:
+ * - mov %rd, $imm, if fits in 5 bits (unsigned);
+ * - movhi %rd, $hi, if the low byte is zero;
+ * - movhi %rd, $hi + movlo %rd, $lo, otherwise.
+ *
+ * Labels always expand to movhi/movlo, since their address may
+ * not be known yet. None of them changes the flags.
+ *
+ * @param line Current line.
+ * @param tbl Instructon table entry.
+ * @param insn Current instruction.
+ *
+ * @return Returns 1 if success and 0 otherwise.
+ */
+static int parse_li(struct tas_ctx *ctx, char **line,
+	const struct insn_tbl *tbl, struct insn *insn)
+{
+	struct token tok; /* Label name.           */
+	struct insn hi;   /* MOVHI.                */
+	struct insn lo;   /* MOVLO.                */
+	char *p = *line;  /* Current line pointer. */
+	long imm;         /* Immediate value.      */
+	int count;        /* Emitted instructions. */
+	int rd;           /* Destination register. */
+
+	if (!read_first_operand(ctx, &p, tbl, insn))
+		return (0);
+
+	rd = (insn->insn >> 8) & 7;
+
+	skip_whitespace(&p);
+	if (!match(ctx, &p, ',', M_I, M_NS))
+		goto err;
+	skip_whitespace(&p);
+
+	memset(&hi, 0, sizeof(hi));
+	memset(&lo, 0, sizeof(lo));
+	INSN_SET_OPCODE(&hi, OPC_MOVHI);
+	INSN_SET_RD(&hi, rd);
+	INSN_SET_OPCODE(&lo, OPC_MOVLO);
+	INSN_SET_RD(&lo, rd);
+	hi.pc = ctx->current_pc;
+	lo.pc = ctx->current_pc + 1;
+
+	/* Immediate. */
+	if (match(ctx, &p, '$', M_IC, M_S))
+	{
+		imm = read_number(ctx, &p, M_NS);
+		if (imm == LONG_MAX || imm < MIN_IMM_LI || imm > MAX_IMM_LI)
+		{
+			error(ctx, "invalid number or out-of-range (expects: %d -- %d)\n",
+				MIN_IMM_LI, MAX_IMM_LI);
+			goto err;
+		}
+
+		imm  &= 0xFFFF;
+		count = 2;
+
+		/* mov %rd, $imm. */
+		if (imm <= MAX_IMM_AMI)
+		{
+			hi.insn = 0;
+			INSN_SET_OPCODE(&hi, OPC_MOV);
+			INSN_SET_RD(&hi, rd);
+			INSN_SET_IMM5(&hi, imm);
+			count = 1;
+		}
+		else
+		{
+			INSN_SET_IMM8(&hi, imm >> 8);
+			INSN_SET_IMM8(&lo, imm);
+			if (!(imm & 0xFF))
+				count = 1;
+		}
+	}
+
+	/* Label. */
+	else
+	{
+		if (!read_token(&p, &tok))
+			goto err;
+		if (!resolve_label(ctx, S_TYPE_HI, &tok, &hi) ||
+			!resolve_label(ctx, S_TYPE_LO, &tok, &lo))
+		{
+			goto err;
+		}
+		count = 2;
+	}
+
+	if (!check_eol(ctx, &p))
+		goto err;
+
+	if (!emit_word(ctx, hi.insn))
+		return (0);
+	if (count > 1 && !emit_word(ctx, lo.insn))
+		return (0);
+
+	*line = p;
+	return (1);
+err:
+	error(ctx, "second operand of instruction '%s' is invalid!\n",
+		tbl->name);
+	return (0);
+}
+
+/**
+ * @brief Parses the call pseudo-instruction: call label (or
+ * $imm), i.e: a jal, that saves the return address in r7.
+ *
+ * @param line Current line.
+ * @param tbl Instructon table entry.
+ * @param insn Current instruction.
+ *
+ * @return Returns 1 if success and 0 otherwise.
+ *
+ * @note Register-based JALs always jump to r7, so
+ * registers are not accepted here.
+ */
+static int parse_call(struct tas_ctx *ctx, char **line,
+	const struct insn_tbl *tbl, struct insn *insn)
+{
+	char *p = *line; /* Current line pointer. */
+
+	if (match(ctx, &p, '%', M_NI, M_S))
+	{
+		error(ctx, "'%s' expects a label or an immediate value!\n",
+			tbl->name);
+		return (0);
+	}
+
+	if (!parse_one_param(ctx, &p, &insn_tbl[I_JAL], insn))
+		return (0);
+	if (!emit_insn(ctx, insn))
+		return (0);
+
+	*line = p;
+	return (1);
+}
+
+/**
+ * @brief Parses the ret pseudo-instruction, i.e: j %r7.
+ *
+ * @param line Current line.
+ * @param tbl Instructon table entry.
+ * @param insn Current instruction.
+ *
+ * @return Returns 1 if success and 0 otherwise.
+ */
+static int parse_ret(struct tas_ctx *ctx, char **line,
+	const struct insn_tbl *tbl, struct insn *insn)
+{
+	char *p = *line; /* Current line pointer. */
+
+	if (!check_eol(ctx, &p))
+	{
+		error(ctx, "instruction '%s' has no operands!\n", tbl->name);
+		return (0);
+	}
+
+	INSN_SET_OPCODE(insn, OPC_J);
+	INSN_SET_RD(insn, REG_RA);
+	if (!emit_word(ctx, insn->insn))
+		return (0);
+
+	*line = p;
+	return (1);
+}
+
+/**
+ * @brief Parses the push and pop pseudo-instructions operand,
+ * a single register.
+ *
+ * @param line Current line.
+ * @param tbl Instructon table entry.
+ * @param insn Current instruction.
+ *
+ * @return Returns the register if success and -1 otherwise.
+ */
+static int read_stack_operand(struct tas_ctx *ctx, char **line,
+	const struct insn_tbl *tbl, struct insn *insn)
+{
+	char *p = *line; /* Current line pointer. */
+
+	if (!read_first_operand(ctx, &p, tbl, insn))
+		return (-1);
+
+	if (!check_eol(ctx, &p))
+	{
+		error(ctx, "instruction '%s' expects a single register!\n",
+			tbl->name);
+		return (-1);
+	}
+
+	*line = p;
+	return ((insn->insn >> 8) & 7);
+}
+
+/**
+ * @brief Parses the push pseudo-instruction: push %rX, i.e:
+ * sub %r6, $1 + sw %rX, $0(%r6).
+ *
+ * @param line Current line.
+ * @param tbl Instructon table entry.
+ * @param insn Current instruction.
+ *
+ * @return Returns 1 if success and 0 otherwise.
+ *
+ * @note Both instructions change the flags.
+ */
+static int parse_push(struct tas_ctx *ctx, char **line,
+	const struct insn_tbl *tbl, struct insn *insn)
+{
+	struct insn sp; /* Stack pointer update. */
+	int reg;        /* Pushed register.      */
+
+	if ((reg = read_stack_operand(ctx, line, tbl, insn)) < 0)
+		return (0);
+
+	memset(&sp, 0, sizeof(sp));
+	INSN_SET_OPCODE(&sp, OPC_SUB);
+	INSN_SET_RD(&sp, REG_SP);
+	INSN_SET_IMM5(&sp, 1);
+
+	insn->insn = 0;
+	INSN_SET_OPCODE(insn, OPC_SW);
+	INSN_SET_RD(insn, reg);
+	INSN_SET_RS(insn, REG_SP);
+
+	return (emit_word(ctx, sp.insn) && emit_word(ctx, insn->insn));
+}
+
+/**
+ * @brief Parses the pop pseudo-instruction: pop %rX, i.e:
+ * lw %rX, $0(%r6) + add %r6, $1.
+ *
+ * @param line Current line.
+ * @param tbl Instructon table entry.
+ * @param insn Current instruction.
+ *
+ * @return Returns 1 if success and 0 otherwise.
+ *
+ * @note Both instructions change the flags.
+ */
+static int parse_pop(struct tas_ctx *ctx, char **line,
+	const struct insn_tbl *tbl, struct insn *insn)
+{
+	struct insn sp; /* Stack pointer update. */
+	int reg;        /* Popped register.      */
+
+	if ((reg = read_stack_operand(ctx, line, tbl, insn)) < 0)
+		return (0);
+
+	memset(&sp, 0, sizeof(sp));
+	INSN_SET_OPCODE(&sp, OPC_ADD);
+	INSN_SET_RD(&sp, REG_SP);
+	INSN_SET_IMM5(&sp, 1);
+
+	insn->insn = 0;
+	INSN_SET_OPCODE(insn, OPC_LW);
+	INSN_SET_RD(insn, reg);
+	INSN_SET_RS(insn, REG_SP);
+
+	return (emit_word(ctx, insn->insn) && emit_word(ctx, sp.insn));
+}
+
+/**
+ * @brief Reads all the remaining content of the file descriptor
+ * @p fd into a single (NUL-padded, see SRC_PAD) heap buffer.
+ *
+ * @param fd File descriptor to be read, may be a pipe.
+ *
+ * @return Returns 1 if success and 0 otherwise.
+ */
+static int read_source(struct tas_ctx *ctx, int fd)
+{
+	size_t capacity; /* Buffer capacity. */
+	ssize_t r;       /* Bytes read.      */
+	char *buf;       /* New buffer.      */
+
+	capacity = 1 << 16;
+	ctx->src_size = 0;
+	if ((ctx->src_buf = malloc(capacity)) == NULL)
+		return (0);
+
+	for (;;)
+	{
+		/* Always keep room for the NUL padding. */
+		if (ctx->src_size + SRC_PAD >= capacity)
+		{
+			capacity <<= 1;
+			if ((buf = realloc(ctx->src_buf, capacity)) == NULL)
+				return (0);
+			ctx->src_buf = buf;
+		}
+
+		r = read(fd, ctx->src_buf + ctx->src_size,
+			capacity - ctx->src_size - SRC_PAD);
+		if (r < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			return (0);
+		}
+		if (r == 0)
+			break;
+
+		ctx->src_size += (size_t)r;
+	}
+
+	memset(ctx->src_buf + ctx->src_size, 0, SRC_PAD);
+	return (1);
+}
+
+/**
+ * @brief Reads the whole file @p file into a heap buffer.
+ *
+ * @param file File to be read, if '-', reads from stdin.
+ * @param buf Output buffer, must be released with free().
+ * @param size Buffer size.
+ *
+ * @return Returns 0 if success and -1 otherwise.
+ */
+int tas_read_file(const char *file, char **buf, size_t *size)
+{
+	size_t capacity; /* Buffer capacity. */
+	struct stat st;  /* File status.     */
+	char *tmp;       /* Realloc'd buffer. */
+	ssize_t r;       /* Read return.     */
+	int fd;          /* File descriptor. */
+
+	if (!strcmp(file, "-"))
+		fd = STDIN_FILENO;
+	else if ((fd = open(file, O_RDONLY)) < 0)
+		return (-1);
+
+	capacity = 4096;
+	if (!fstat(fd, &st) && S_ISREG(st.st_mode) && st.st_size > 0)
+		capacity = (size_t)st.st_size + 1;
+
+	*size = 0;
+	if ((*buf = malloc(capacity)) == NULL)
+		goto err;
+
+	for (;;)
+	{
+		if (*size == capacity)
+		{
+			if ((tmp = realloc(*buf, capacity << 1)) == NULL)
+				goto err;
+			*buf = tmp;
+			capacity <<= 1;
+		}
+
+		r = read(fd, *buf + *size, capacity - *size);
+		if (r < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			goto err;
+		}
+		if (r == 0)
+			break;
+		*size += (size_t)r;
+	}
+
+	if (fd != STDIN_FILENO)
+		close(fd);
+	return (0);
+err:
+	free(*buf);
+	*buf = NULL;
+	if (fd != STDIN_FILENO)
+		close(fd);
+	return (-1);
+}
+
+/**
+ * @brief Loads the whole source file @p file into memory, so
+ * the parser can tokenize it in place.
+ *
+ * Regular files are memory-mapped when possible, anything else
+ * (stdin, pipes...) is read at once into a single buffer.
+ *
+ * @param file File to be loaded, '-' means stdin.
+ *
+ * @return Returns 1 if success and 0 otherwise.
+ */
+static int load_source(struct tas_ctx *ctx, const char *file)
+{
+	struct stat st; /* File status.     */
+	long pagesz;    /* System pagesize. */
+	long tail;      /* Last page usage. */
+	int ret;        /* Return code.     */
+	int fd;         /* File descriptor. */
+
+	if (!strcmp(file, "-"))
+		return (read_source(ctx, STDIN_FILENO));
+
+	if ((fd = open(file, O_RDONLY)) < 0)
+		return (0);
+
+	if (fstat(fd, &st) < 0)
+	{
+		close(fd);
+		return (0);
+	}
+
+	/*
+	 * The parser relies on a NUL-padded buffer: since the
+	 * remainder of the last page of a mapping is zero-filled,
+	 * this comes for free, unless the last page has less than
+	 * SRC_PAD bytes left, in which case we just read it.
+	 */
+	pagesz = sysconf(_SC_PAGESIZE);
+	tail   = pagesz > 0 ? (long)(st.st_size % pagesz) : 0;
+	if (S_ISREG(st.st_mode) && st.st_size > 0 && tail != 0 &&
+		pagesz - tail >= SRC_PAD)
+	{
+		ctx->src_buf = mmap(NULL, (size_t)st.st_size, PROT_READ,
+			MAP_PRIVATE, fd, 0);
+
+		if (ctx->src_buf != MAP_FAILED)
+		{
+			posix_madvise(ctx->src_buf, (size_t)st.st_size,
+				POSIX_MADV_SEQUENTIAL);
+			ctx->src_size   = (size_t)st.st_size;
+			ctx->src_mapped = 1;
+			close(fd);
+			return (1);
+		}
+		ctx->src_buf = NULL;
+	}
+
+	ret = read_source(ctx, fd);
+	close(fd);
+	return (ret);
+}
+
+/**
+ * @brief Skips the remaining of the current line, stopping
+ * at the line break (or at the end of the buffer).
+ *
+ * @param s Line pointer.
+ */
+static inline void skip_line(char **s)
+{
+	char *p = *s; /* Current line pointer. */
+#ifdef LEX_SIMD
+	int n;
+	while ((n = vec_span_line(p)) == 16)
+		p += 16;
+	p += n;
+#else
+	while (!(CLASS(*p) & C_EOL))
+		p++;
+#endif
+	*s = p;
+}
+
+/**
+ * @brief Parses the directive at @p line, the '.' already skipped.
+ *
+ * The only one supported is '.scratch %rN', the long branches
+ * scratch register (see REG_AT); the others (i.e: GNU AS ones)
+ * are ignored, as well as the remaining line.
+ *
+ * @param line Current line.
+ *
+ * @return Returns 1 if success and 0 otherwise.
+ */
+static int parse_directive(struct tas_ctx *ctx, char **line)
+{
+	struct token tok; /* Directive name.       */
+	char *p = *line;  /* Current line pointer. */
+
+	if (!read_token(&p, &tok) || tok.len != 7 ||
+		memcmp(tok.str, "scratch", 7))
+	{
+		skip_line(line);
+		return (1);
+	}
+
+	/*
+	 * r6 and r7 are the stack pointer and the return address, and
+	 * 'j %r0' encodes as 'j $0' (RD = 0 is the immediate form).
+	 */
+	if (!match(ctx, &p, '%', M_IC, M_S) ||
+		!match(ctx, &p, 'r', M_IC, M_S) ||
+		match_lt(ctx, &p, '1', M_NI, M_S) ||
+		match_gt(ctx, &p, '5', M_I, M_S)  ||
+		!check_eol(ctx, &p))
+	{
+		error(ctx, "directive '.scratch' expects a register, from "
+			"%%r1 to %%r5\n");
+		return (0);
+	}
+
+	ctx->scratch = *(p - 1) - '0';
+	*line = p;
+	return (1);
+}
+
+/**
+ * @brief Parses all the instructions from the current loaded
+ * source and creates a list of labels and instructions.
+ *
+ * @return Returns 1 if success and 0 otherwise.
+ */
+static int parse_insn(struct tas_ctx *ctx)
+{
+	const struct insn_tbl *tbl; /* Instruction table entry. */
+	struct insn insn;           /* Current instruction.     */
+	struct token tok;           /* 'Token' read.            */
+	char *p;                    /* Current character.       */
+
+	ctx->current_line = 1;
+	p = ctx->src_buf;
+
+	/* Process the whole buffer, line by line. */
+	while (*p)
+	{
+		skip_whitespace(&p);
+
+		/* Next line. */
+		if (match(ctx, &p, '\n', M_IC, M_S))
+		{
+			ctx->current_line++;
+			continue;
+		}
+
+		/* If comment, ignore the remaining line. */
+		if (match(ctx, &p, '#', M_NI, M_S))
+		{
+			skip_line(&p);
+			continue;
+		}
+
+		/* Directives. */
+		if (match(ctx, &p, '.', M_IC, M_S))
+		{
+			if (!parse_directive(ctx, &p))
+				goto err0;
+			continue;
+		}
+
+		/* End of buffer. */
+		if (match(ctx, &p, '\0', M_NI, M_S))
+			break;
+
+		/* Read token. */
+		if (!read_token(&p, &tok))
+			goto err0;
+
+		/* Check if label or instruction. */
+		if (match(ctx, &p, ':', M_IC, M_S))
+		{
+			if (!add_label(ctx, &tok, ctx->current_pc))
+				goto err0;
+		}
+		else
+		{
+			if ((tbl = find_insn(&tok)) == NULL)
+			{
+				error(ctx, "instruction (%.*s) not exist!\n", (int)tok.len,
+					tok.str);
+				goto err0;
+			}
+
+			/* Parse a instruction. */
+			memset(&insn, 0, sizeof(insn));
+			if (!tbl->parser(ctx, &p, tbl, &insn))
+			{
+				error(ctx, "error while parsing (%.*s)\n", (int)tok.len, tok.str);
+				goto err0;
+			}
+
+			/*
+			 * Add instruction to the output, pseudo-instructions
+			 * already emitted theirs.
+			 */
+			if (tbl->type != INSN_PSE && !emit_insn(ctx, &insn))
+				goto err0;
+		}
+	}
+	return (1);
+err0:
+	return (0);
+}
+
+/**
+ * @brief Reports all the labels referenced but never defined.
+ *
+ * All the other references were already resolved, either
+ * right away or when its label got defined.
+ *
+ * @return Returns 1 if all the labels are defined and 0
+ * otherwise.
+ */
+static int check_labels(struct tas_ctx *ctx)
+{
+	struct fixup *fixup; /* Current fixup. */
+	struct label *lbl;   /* Current label. */
+	int ret;             /* Return code.   */
+
+	ret = 1;
+	for (lbl = ctx->undef; lbl; lbl = lbl->next_undef)
+	{
+		if (lbl->defined)
+			continue;
+
+		for (fixup = lbl->pending; fixup; fixup = fixup->next)
+		{
+			ctx->current_line = fixup->line;
+			error(ctx, "label (%.*s) not found!\n", (int)lbl->name.len,
+				lbl->name.str);
+		}
+		ret = 0;
+	}
+	return (ret);
+}
+
+/**
+ * @brief Reports the long branches whose scratch register is
+ * also used by the source, since the branch would clobber it.
+ *
+ * @return Returns 1 if there is no conflict and 0 otherwise.
+ */
+static int check_scratch(struct tas_ctx *ctx)
+{
+	int reg; /* Register.    */
+	int ret; /* Return code. */
+
+	ret = 1;
+	for (reg = 0; reg < 8; reg++)
+	{
+		if (!ctx->clobber_line[reg] || !ctx->reg_line[reg])
+			continue;
+
+		ctx->current_line = ctx->clobber_line[reg];
+		error(ctx, "long branch clobbers %%r%d, used at line %d, "
+			"see '.scratch'\n", reg, ctx->reg_line[reg]);
+		ret = 0;
+	}
+	return (ret);
+}
+
+/**
+ * @brief Parses (a single pass) the source already loaded
+ * into @p ctx.
+ *
+ * @param ctx Assembler context.
+ *
+ * @return Returns 1 if success and 0 otherwise.
+ */
+static int parse_pass(struct tas_ctx *ctx)
+{
+	/* Allocator. */
+	if (arena_init(&ctx->arena) < 0)
+		return (0);
+
+	/* Label hashtable. */
+	if (hashtable_init(&ctx->ht_lbls, token_setup) < 0)
+		return (0);
+	if (hashtable_set_arena(&ctx->ht_lbls, ctx->arena) < 0)
+		return (0);
+
+	/* Instruction list, its lines, symbols and forward references. */
+	if (code_vec_init(&ctx->code_out) < 0)
+		return (0);
+	if (line_vec_init(&ctx->line_out) < 0)
+		return (0);
+	if (sym_vec_init(&ctx->syms) < 0)
+		return (0);
+	ctx->undef       = NULL;
+	ctx->undef_end   = &ctx->undef;
+	ctx->current_pc  = 0;
+	ctx->bra_count   = 0;
+	ctx->relax_again = 0;
+	ctx->scratch     = REG_AT;
+	memset(ctx->reg_line, 0, sizeof(ctx->reg_line));
+	memset(ctx->clobber_line, 0, sizeof(ctx->clobber_line));
+
+	/* Parse. */
+	if (!parse_insn(ctx))
+		return (0);
+	if (!check_labels(ctx))
+		return (0);
+	if (!check_scratch(ctx))
+		return (0);
+
+	return (1);
+}
+
+/**
+ * @brief Releases the resources of a single parse pass.
+ */
+static void free_pass(struct tas_ctx *ctx)
+{
+	/* Label hashtable. */
+	hashtable_finish(&ctx->ht_lbls, 0);
+	ctx->ht_lbls = NULL;
+
+	/* Instruction list, lines and symbols. */
+	code_vec_finish(&ctx->code_out);
+	line_vec_finish(&ctx->line_out);
+	sym_vec_finish(&ctx->syms);
+
+	/* Labels and hashtable nodes. */
+	arena_finish(&ctx->arena);
+}
+
+/**
+ * @brief Parses the source already loaded into @p ctx.
+ *
+ * Branches are relaxed iteratively: each pass that finds out
+ * of range (label) branches marks them and the source is parsed
+ * again, with the long form for them, until all fit.
+ *
+ * @param ctx Assembler context.
+ *
+ * @return Returns 1 if success and 0 otherwise.
+ */
+static int parse(struct tas_ctx *ctx)
+{
+	if (relax_vec_init(&ctx->relax) < 0)
+		return (0);
+
+	for (;;)
+	{
+		if (!parse_pass(ctx))
+			return (0);
+		if (!ctx->relax_again)
+			break;
+		free_pass(ctx);
+	}
+
+	return (1);
+}
+
+/**
+ * @brief Frees all allocated resources used during the parsing.
+ */
+static void free_resources(struct tas_ctx *ctx)
+{
+	/* Release the source buffer. */
+	if (ctx->src_buf)
+	{
+		if (ctx->src_mapped)
+			munmap(ctx->src_buf, ctx->src_size);
+		else
+			free(ctx->src_buf);
+	}
+
+	/* Parse pass and branch relaxation. */
+	free_pass(ctx);
+	relax_vec_finish(&ctx->relax);
+}
+
+/**
+ * @brief Copies the symbols of @p ctx into @p img, since the
+ * names point into the source buffer.
+ *
+ * @param ctx Assembler context.
+ * @param img Output image.
+ *
+ * @return Returns 1 if success and 0 otherwise.
+ */
+static int export_symbols(struct tas_ctx *ctx, struct tas_image *img)
+{
+	struct symbol *sym; /* Current symbol. */
+	size_t nsyms;       /* Symbols count.  */
+
+	nsyms = sym_vec_size(&ctx->syms);
+	if (!nsyms)
+		return (1);
+
+	if ((img->syms = calloc(nsyms, sizeof(*img->syms))) == NULL)
+		goto err;
+
+	for (img->nsyms = 0; img->nsyms < nsyms; img->nsyms++)
+	{
+		sym = sym_vec_get(&ctx->syms, img->nsyms);
+		img->syms[img->nsyms].name = malloc(sym->name.len + 1);
+		if (!img->syms[img->nsyms].name)
+			goto err;
+
+		memcpy(img->syms[img->nsyms].name, sym->name.str, sym->name.len);
+		img->syms[img->nsyms].name[sym->name.len] = '\0';
+		img->syms[img->nsyms].addr = (size_t)sym->off;
+	}
+	return (1);
+err:
+	error(ctx, "unable to allocate the symbols\n");
+	return (0);
+}
+
+/**
+ * @brief Assembles the source loaded into @p ctx and hands the
+ * resulting image over to @p img.
+ *
+ * @param ctx Assembler context.
+ * @param img Output image.
+ *
+ * @return Returns 0 if success and -1 otherwise.
+ */
+static int assemble(struct tas_ctx *ctx, struct tas_image *img)
+{
+	int ret; /* Return code. */
+
+	ret = -1;
+	if (parse(ctx) && export_symbols(ctx, img))
+	{
+		/* Steal the instructions and lines buffers. */
+		img->code  = ctx->code_out->buf;
+		img->size  = ctx->code_out->elements;
+		img->lines = ctx->line_out->buf;
+		ctx->code_out->buf = NULL;
+		ctx->line_out->buf = NULL;
+		ret = 0;
+	}
+	else
+		tas_image_free(img);
+
+	free_resources(ctx);
+	return (ret);
+}
+
+/**
+ * @brief Assembles the source buffer @p src, of @p size bytes.
+ *
+ * The buffer does not need to be NUL-terminated and is not
+ * modified. All errors are reported through @p diag, if any.
+ *
+ * @param src  Source buffer.
+ * @param size Source size, in bytes.
+ * @param name Source name, used in the diagnostics.
+ * @param diag Diagnostics callback, may be NULL.
+ * @param data User data passed to @p diag.
+ * @param img  Output image, must be released with
+ *             tas_image_free().
+ *
+ * @return Returns 0 if success and -1 otherwise.
+ */
+int tas_assemble_buffer(const char *src, size_t size, const char *name,
+	tas_diag_t diag, void *data, struct tas_image *img)
+{
+	struct tas_ctx ctx; /* Assembler context. */
+
+	if (!img || (!src && size))
+		return (-1);
+
+	memset(img, 0, sizeof(*img));
+	memset(&ctx, 0, sizeof(ctx));
+	ctx.src_file  = name ? name : "<buffer>";
+	ctx.diag      = diag;
+	ctx.diag_data = data;
+
+	/* The parser expects a NUL-padded source. */
+	if ((ctx.src_buf = malloc(size + SRC_PAD)) == NULL)
+	{
+		error(&ctx, "unable to allocate the source buffer\n");
+		return (-1);
+	}
+	if (size)
+		memcpy(ctx.src_buf, src, size);
+	memset(ctx.src_buf + size, 0, SRC_PAD);
+	ctx.src_size = size;
+
+	return (assemble(&ctx, img));
+}
+
+/**
+ * @brief Assembles the file @p file, if '-', the source is
+ * read from stdin.
+ *
+ * @param file Source file.
+ * @param diag Diagnostics callback, may be NULL.
+ * @param data User data passed to @p diag.
+ * @param img  Output image, must be released with
+ *             tas_image_free().
+ *
+ * @return Returns 0 if success and -1 otherwise.
+ */
+int tas_assemble_file(const char *file, tas_diag_t diag, void *data,
+	struct tas_image *img)
+{
+	struct tas_ctx ctx; /* Assembler context. */
+	const char *base;   /* File basename.     */
+
+	if (!file || !img)
+		return (-1);
+
+	memset(img, 0, sizeof(*img));
+	memset(&ctx, 0, sizeof(ctx));
+	base = strrchr(file, '/');
+	ctx.src_file  = base ? base + 1 : file;
+	ctx.diag      = diag;
+	ctx.diag_data = data;
+
+	if (!load_source(&ctx, file))
+	{
+		error(&ctx, "unable to read file (%s)\n", file);
+		free_resources(&ctx);
+		return (-1);
+	}
+
+	return (assemble(&ctx, img));
+}
+
+/**
+ * @brief Returns the code generator version, which identifies
+ * the output of this build for a given source (e.g: for the
+ * outputs cache).
+ *
+ * @return Returns the version string.
+ */
+const char *tas_version(void)
+{
+	return (TAS_VERSION);
+}
+
+/**
+ * @brief Releases an image returned by the assemble functions.
+ *
+ * @param img Image to be released.
+ */
+void tas_image_free(struct tas_image *img)
+{
+	if (!img)
+		return;
+
+	for (size_t i = 0; i < img->nsyms; i++)
+		free(img->syms[i].name);
+	free(img->syms);
+	free(img->lines);
+	free(img->code);
+	memset(img, 0, sizeof(*img));
+}
+
+/**
+ * @brief Checks if @p img fits in a memory of @p mem_size words
+ * and, optionally, pads it with zeros up to the memory size, so
+ * that the whole memory gets initialized.
+ *
+ * @param img Assembled image.
+ * @param mem_size Memory size, in words.
+ * @param pad If non-zero, pads the image.
+ *
+ * @return Returns 0 if success and -1 otherwise, i.e: the image
+ * is bigger than the memory, or out of memory.
+ */
+int tas_image_fit(struct tas_image *img, size_t mem_size, int pad)
+{
+	uint16_t *code; /* Padded code.  */
+	int *lines;     /* Padded lines. */
+
+	if (!img || img->size > mem_size)
+		return (-1);
+
+	if (!pad || img->size == mem_size)
+		return (0);
+
+	code = realloc(img->code, mem_size * sizeof(*code));
+	if (!code)
+		return (-1);
+	img->code = code;
+
+	/* Padding has no source line. */
+	if (img->lines)
+	{
+		lines = realloc(img->lines, mem_size * sizeof(*lines));
+		if (!lines)
+			return (-1);
+		memset(lines + img->size, 0, (mem_size - img->size) * sizeof(*lines));
+		img->lines = lines;
+	}
+
+	memset(code + img->size, 0, (mem_size - img->size) * sizeof(*code));
+	img->size = mem_size;
+	return (0);
+}
@@ -0,0 +1,263 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Davidson Francis <davidsondfgl@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "listing.h"
+#include "tas.h"
+
+/*
+ * Static cost, in clocks, of an instruction or a block: the
+ * cost of conditional branches and register shifts depends
+ * on the data, so both bounds are kept.
+ */
+struct cost
+{
+	unsigned long min;
+	unsigned long max;
+};
+
+/* Basic block, i.e: the words between two labels. */
+struct block
+{
+	const char *name;
+	size_t insns;
+	struct cost cost;
+};
+
+/**
+ * @brief Estimates the cost of the instruction @p insn.
+ *
+ * @param insn Encoded instruction.
+ * @param cost Output cost.
+ */
+static void insn_cost(uint16_t insn, struct cost *cost)
+{
+	unsigned amt; /* Shift amount. */
+	uint8_t opc;  /* Opcode.       */
+
+	opc = INSN_GET_OPCODE(insn);
+	cost->min = cost->max = FSM_AMI;
+
+	/* Shifts: reg/reg amounts are unknown, from 0 up to 15. */
+	if (opc == OPC_SLL || opc == OPC_SLR)
+	{
+		if ((insn >> 5) & 7)
+			cost->max += LST_SHIFT_MAX;
+		else
+		{
+			amt = insn & 0xF;
+			cost->min += SHIFT_CYCLES(amt);
+			cost->max  = cost->min;
+		}
+	}
+
+	/* Branches: J/JAL are always taken. */
+	else if (opc >= OPC_JE && opc <= OPC_JAL)
+	{
+		cost->min = FSM_BRA;
+		cost->max = FSM_BRA_TAKEN;
+		if (opc == OPC_J || opc == OPC_JAL)
+			cost->min = FSM_BRA_TAKEN;
+	}
+
+	/* Load/Store. */
+	else if (opc == OPC_LW)
+		cost->min = cost->max = FSM_LW;
+	else if (opc == OPC_SW)
+		cost->min = cost->max = FSM_SW;
+}
+
+/**
+ * @brief Prints the cost @p cost, as 'min' or 'min-max', right
+ * aligned in @p width chars.
+ *
+ * @param out Output file.
+ * @param cost Cost to be printed.
+ * @param width Field width.
+ */
+static void print_cost(FILE *out, const struct cost *cost, int width)
+{
+	char buf[48]; /* Formatted cost. */
+
+	if (cost->min == cost->max)
+		snprintf(buf, sizeof(buf), "%lu", cost->min);
+	else
+		snprintf(buf, sizeof(buf), "%lu-%lu", cost->min, cost->max);
+	fprintf(out, "%*s", width, buf);
+}
+
+/**
+ * @brief Prints the totals of the block @p blk, if not empty,
+ * and starts a new one, named @p name.
+ *
+ * @param out Output file.
+ * @param blk Current block.
+ * @param name Next block name.
+ */
+static void end_block(FILE *out, struct block *blk, const char *name)
+{
+	if (blk->insns)
+	{
+		fprintf(out, "                    # %s: %zu insn%s, ", blk->name,
+			blk->insns, blk->insns > 1 ? "s" : "");
+		print_cost(out, &blk->cost, 0);
+		fprintf(out, " cycles\n\n");
+	}
+
+	blk->name     = name;
+	blk->insns    = 0;
+	blk->cost.min = 0;
+	blk->cost.max = 0;
+}
+
+/**
+ * @brief Builds the line index of the source @p src, i.e: the
+ * offset where each line starts, 1-based, as the parser counts.
+ *
+ * @param src Source buffer.
+ * @param size Source size.
+ * @param nlines Output amount of lines (+1).
+ *
+ * @return Returns the line index, or NULL if error.
+ */
+static size_t *index_lines(const char *src, size_t size, size_t *nlines)
+{
+	size_t *idx; /* Line index. */
+	size_t n;    /* Lines.      */
+
+	n = 2;
+	for (size_t i = 0; i < size; i++)
+		n += (src[i] == '\n');
+
+	if ((idx = malloc(n * sizeof(*idx))) == NULL)
+		return (NULL);
+
+	idx[0] = idx[1] = 0;
+	*nlines = 2;
+	for (size_t i = 0; i < size; i++)
+		if (src[i] == '\n')
+			idx[(*nlines)++] = i + 1;
+
+	return (idx);
+}
+
+/**
+ * @brief Writes the listing of @p img, assembled from @p src, into
+ * the file @p file ('-' for stdout): the address, encoding, estimated
+ * cycles (see listing.h) and source line of each word, and the totals
+ * of each label-delimited block.
+ *
+ * The block totals are straight-line costs, i.e: as if each
+ * instruction were executed once.
+ *
+ * @param file Output file.
+ * @param img Assembled image, not padded.
+ * @param src Source buffer.
+ * @param size Source size.
+ *
+ * @return Returns 0 if success and -1 otherwise.
+ */
+int listing_write(const char *file, const struct tas_image *img,
+	const char *src, size_t size)
+{
+	struct cost cost;   /* Instruction cost. */
+	struct block blk;   /* Current block.    */
+	size_t *idx;        /* Line index.       */
+	size_t nlines;      /* Source lines.     */
+	size_t sym;         /* Next symbol.      */
+	size_t len;         /* Line length.      */
+	const char *line;   /* Source line.      */
+	FILE *out;          /* Listing file.     */
+	int ret;            /* Return code.      */
+
+	if (!file || !img || (!src && size))
+		return (-1);
+
+	if ((idx = index_lines(src, size, &nlines)) == NULL)
+		return (-1);
+
+	if (!strcmp(file, "-"))
+		out = stdout;
+	else if ((out = fopen(file, "w")) == NULL)
+	{
+		free(idx);
+		return (-1);
+	}
+
+	fprintf(out, "# Addr  Code  Cycles  Line  Source\n");
+
+	memset(&blk, 0, sizeof(blk));
+	blk.name = "(start)";
+	sym = 0;
+
+	for (size_t pc = 0; pc < img->size; pc++)
+	{
+		/* Labels delimit the blocks. */
+		for (; sym < img->nsyms && img->syms[sym].addr <= pc; sym++)
+		{
+			end_block(out, &blk, img->syms[sym].name);
+			fprintf(out, "%s:\n", img->syms[sym].name);
+		}
+
+		insn_cost(img->code[pc], &cost);
+		blk.insns++;
+		blk.cost.min += cost.min;
+		blk.cost.max += cost.max;
+
+		fprintf(out, "  %04zx  %04x  ", pc, img->code[pc]);
+		print_cost(out, &cost, 6);
+
+		/* Source, only once for multi-word lines. */
+		if (img->lines && img->lines[pc] > 0 &&
+			(size_t)img->lines[pc] < nlines &&
+			(!pc || img->lines[pc - 1] != img->lines[pc]))
+		{
+			line = src + idx[img->lines[pc]];
+			while (line < src + size && (*line == ' ' || *line == '\t'))
+				line++;
+			for (len = 0; line + len < src + size && line[len] != '\n'; len++);
+			while (len && (line[len - 1] == '\r' || line[len - 1] == ' ' ||
+				line[len - 1] == '\t'))
+				len--;
+			fprintf(out, "  %4d  %.*s", img->lines[pc], (int)len, line);
+		}
+		fputc('\n', out);
+	}
+	end_block(out, &blk, NULL);
+
+	/* Labels at the end. */
+	for (; sym < img->nsyms; sym++)
+		fprintf(out, "%s:\n", img->syms[sym].name);
+
+	ret = ferror(out) ? -1 : 0;
+	if (out != stdout)
+		ret |= fclose(out) ? -1 : 0;
+	else
+		fflush(out);
+
+	free(idx);
+	return (ret);
+}
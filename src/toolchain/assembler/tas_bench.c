@@ -0,0 +1,557 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Davidson Francis <davidsondfgl@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Assembler benchmarks.
+ *
+ * Micro benchmarks of the data structures used by tas: hashtable
+ * insertions and lookups, for each hash function (sdbm, splitmix64
+ * and MurMur3), collision scheme and a few label counts, and the
+ * growth of the arrays and vectors. And a macro benchmark: tas
+ * (through libtas, i.e: the same path, but the file output)
+ * against a source, usually a synthetic one, as generated with -g.
+ *
+ * All the times are the best of a few rounds, in the host clock.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+#include "array.h"
+#include "hashtable.h"
+#include "libtas.h"
+#include "vector.h"
+
+/* Rounds per measure, the best one is reported. */
+#define ROUNDS 5
+
+/* Minimum amount of operations per round, to be measurable. */
+#define MIN_OPS (1 << 20)
+
+/* Vector of words, as the assembler output. */
+VECTOR_DEFINE(word_vec, uint16_t)
+
+/* Options. */
+static const char *gen_file;
+static const char *asm_file;
+static long gen_mb = 4;
+static int rounds = ROUNDS;
+
+/* Hash functions (and collision schemes) under test. */
+static const struct
+{
+	const char *name;
+	void (*setup)(struct hashtable **);
+} hashes[] = {
+	{"sdbm",            hashtable_sdbm_setup},
+	{"sdbm/oa",         hashtable_sdbm_oa_setup},
+	{"splitmix64",      hashtable_splitmix64_setup},
+	{"splitmix64/oa",   hashtable_splitmix64_oa_setup},
+	{"MurMur3",         hashtable_MurMur3_setup},
+	{"MurMur3/oa",      hashtable_MurMur3_oa_setup},
+};
+
+/* Label counts, from small programs to generated ones. */
+static const size_t label_counts[] = {64, 1024, 16384, 131072};
+
+/* Element counts, for the arrays and vectors. */
+static const size_t grow_counts[] = {1024, 65536, 1 << 20};
+
+#define NELEMS(a) (sizeof(a) / sizeof((a)[0]))
+
+/**
+ * @brief Returns the current (monotonic) time, in seconds.
+ */
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec + ts.tv_nsec / 1e9);
+}
+
+/**
+ * @brief xorshift64 PRNG, for reproducible sources.
+ *
+ * @param s PRNG state, non-zero.
+ *
+ * @return Returns the next pseudo-random number.
+ */
+static inline uint64_t xorshift64(uint64_t *s)
+{
+	uint64_t x = *s;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	*s = x;
+	return (x);
+}
+
+/**
+ * @brief Allocates @p n distinct label names, in the style of
+ * the generated sources, into a single buffer.
+ *
+ * @param n Amount of labels.
+ * @param keys Array of @p n pointers, one per label.
+ *
+ * @return Returns the names buffer if success and NULL otherwise.
+ */
+static char *make_labels(size_t n, char **keys)
+{
+	char *buf; /* Names buffer. */
+	char *p;   /* Current name. */
+
+	if ((buf = malloc(n * 24)) == NULL)
+		return (NULL);
+
+	p = buf;
+	for (size_t i = 0; i < n; i++)
+	{
+		keys[i] = p;
+		p += sprintf(p, "%s_%zu", (i & 1) ? "loop" : "block", i) + 1;
+	}
+	return (buf);
+}
+
+/**
+ * @brief Times the hashtable insertions (from an empty table,
+ * i.e: growth included) and lookups (hits, as the label references)
+ * of @p n labels with the hash function @p h.
+ *
+ * @param h Hash function, index in hashes[].
+ * @param keys Label names.
+ * @param n Amount of labels.
+ *
+ * @return Returns 1 if success and 0 otherwise.
+ */
+static int bench_hashtable(size_t h, char **keys, size_t n)
+{
+	struct hashtable *ht; /* Hashtable.           */
+	double t_add, t_get;  /* Best times.          */
+	double start;         /* Start time.          */
+	double t;             /* Round time.          */
+	size_t reps;          /* Repetitions / round. */
+
+	reps  = n < MIN_OPS ? MIN_OPS / n : 1;
+	t_add = t_get = 1e9;
+
+	for (int r = 0; r < rounds; r++)
+	{
+		/* Insertions, keeps the last table for the lookups. */
+		t = 0;
+		for (size_t k = 0; k < reps; k++)
+		{
+			if (hashtable_init(&ht, hashes[h].setup) < 0)
+				return (0);
+
+			start = now();
+			for (size_t i = 0; i < n; i++)
+				if (hashtable_add(&ht, keys[i], keys[i]) < 0)
+					return (0);
+			t += now() - start;
+
+			if (k != reps - 1)
+				hashtable_finish(&ht, 0);
+		}
+		if (t < t_add)
+			t_add = t;
+
+		/* Lookups. */
+		start = now();
+		for (size_t k = 0; k < reps; k++)
+			for (size_t i = 0; i < n; i++)
+				if (hashtable_get(&ht, keys[i]) != keys[i])
+					return (0);
+		t = now() - start;
+		if (t < t_get)
+			t_get = t;
+
+		hashtable_finish(&ht, 0);
+	}
+
+	printf("%-16s %8zu %12.1f %12.1f\n", hashes[h].name, n,
+		t_add / ((double)reps * n) * 1e9,
+		t_get / ((double)reps * n) * 1e9);
+	return (1);
+}
+
+/**
+ * @brief Times the growth of an array (of pointers) and of a
+ * vector (of words, as the assembler output), up to @p n elements.
+ *
+ * @param n Amount of elements.
+ *
+ * @return Returns 1 if success and 0 otherwise.
+ */
+static int bench_growth(size_t n)
+{
+	struct word_vec *vec; /* Vector.              */
+	struct array *ar;     /* Array.               */
+	double t_ar, t_vec;   /* Best times.          */
+	double start;         /* Start time.          */
+	double t;             /* Round time.          */
+	size_t reps;          /* Repetitions / round. */
+
+	reps = n < MIN_OPS ? MIN_OPS / n : 1;
+	t_ar = t_vec = 1e9;
+
+	for (int r = 0; r < rounds; r++)
+	{
+		start = now();
+		for (size_t k = 0; k < reps; k++)
+		{
+			if (array_init(&ar) < 0)
+				return (0);
+			for (size_t i = 0; i < n; i++)
+				if (array_add(&ar, (void *)i) < 0)
+					return (0);
+			array_finish(&ar);
+		}
+		t = now() - start;
+		if (t < t_ar)
+			t_ar = t;
+
+		start = now();
+		for (size_t k = 0; k < reps; k++)
+		{
+			if (word_vec_init(&vec) < 0)
+				return (0);
+			for (size_t i = 0; i < n; i++)
+				if (word_vec_add(&vec, (uint16_t)i) < 0)
+					return (0);
+			word_vec_finish(&vec);
+		}
+		t = now() - start;
+		if (t < t_vec)
+			t_vec = t;
+	}
+
+	printf("%-16s %8zu %12.2f\n", "array", n,
+		t_ar / ((double)reps * n) * 1e9);
+	printf("%-16s %8zu %12.2f\n", "vector", n,
+		t_vec / ((double)reps * n) * 1e9);
+	return (1);
+}
+
+/**
+ * @brief Runs the data structures micro benchmarks.
+ *
+ * @return Returns 1 if success and 0 otherwise.
+ */
+static int bench_micro(void)
+{
+	size_t max;  /* Max label count. */
+	char **keys; /* Label names.     */
+	char *names; /* Names buffer.    */
+	int ret;     /* Return code.     */
+
+	max = label_counts[NELEMS(label_counts) - 1];
+	if ((keys = malloc(max * sizeof(*keys))) == NULL ||
+		(names = make_labels(max, keys)) == NULL)
+	{
+		fprintf(stderr, "Unable to allocate the labels!\n");
+		free(keys);
+		return (0);
+	}
+
+	ret = 1;
+	printf("%-16s %8s %12s %12s\n", "Hashtable", "Labels",
+		"Insert (ns)", "Lookup (ns)");
+	for (size_t h = 0; h < NELEMS(hashes) && ret; h++)
+		for (size_t i = 0; i < NELEMS(label_counts) && ret; i++)
+			ret = bench_hashtable(h, keys, label_counts[i]);
+
+	printf("\n%-16s %8s %12s\n", "Growth", "Elements", "Add (ns)");
+	for (size_t i = 0; i < NELEMS(grow_counts) && ret; i++)
+		ret = bench_growth(grow_counts[i]);
+
+	if (!ret)
+		fprintf(stderr, "Micro benchmarks failed!\n");
+
+	free(names);
+	free(keys);
+	return (ret);
+}
+
+/**
+ * @brief Generates a synthetic source of (about) @p mb megabytes
+ * into @p file: label-delimited blocks of all the instruction
+ * kinds, with decimal, hex and octal immediates, backward and
+ * forward branches, comments, directives and blank lines.
+ *
+ * The branches never leave the 8-bit range and there are no
+ * absolute jumps, so that any size assembles, even if larger
+ * than the Tangle memory.
+ *
+ * @param file Output file.
+ * @param mb Size, in megabytes.
+ *
+ * @return Returns 1 if success and 0 otherwise.
+ */
+static int generate(const char *file, long mb)
+{
+	static const char *const alu[] = {
+		"or", "and", "xor", "add", "sub", "cmp", "mov"
+	};
+	static const char *const bra[] = {"je", "jne", "jgs", "jlu"};
+	uint64_t seed;  /* PRNG state.         */
+	uint64_t x;     /* Random number.      */
+	uint64_t size;  /* Target size, bytes. */
+	size_t block;   /* Current block.      */
+	FILE *f;        /* Output file.        */
+	int ret;        /* Return code.        */
+
+	if (!(f = fopen(file, "w")))
+	{
+		perror(file);
+		return (0);
+	}
+
+	seed = 0x9E3779B97F4A7C15;
+	size = (uint64_t)mb << 20;
+	fprintf(f, "# Synthetic source, generated by tas_bench -g.\n\n"
+		"\t.text\n");
+
+	for (block = 0; (uint64_t)ftell(f) < size; block++)
+	{
+		if (block % 64 == 0)
+			fprintf(f, "\n# ---- Section %zu "
+				"-----------------------------------------\n\n", block / 64);
+
+		fprintf(f, "block_%zu:\n", block);
+		for (int i = 0; i < 12; i++)
+		{
+			x = xorshift64(&seed);
+			switch (x % 8)
+			{
+				case 0:
+				case 1:
+				case 2:
+					fprintf(f, "\t%s %%r%d, %%r%d\n", alu[(x >> 8) % 7],
+						(int)((x >> 16) % 7) + 1, (int)((x >> 24) % 8));
+					break;
+				case 3:
+					fprintf(f, "\t%s %%r%d, $%d\n", alu[(x >> 8) % 7],
+						(int)((x >> 16) % 7) + 1, (int)((x >> 24) % 16));
+					break;
+				case 4:
+					fprintf(f, "\tsll %%r%d, $0x%x    # shift\n",
+						(int)((x >> 16) % 7) + 1, (unsigned)((x >> 24) % 15) + 1);
+					break;
+				case 5:
+					fprintf(f, "\tlw %%r%d, $%d(%%r%d)\n",
+						(int)((x >> 16) % 7) + 1, (int)((x >> 24) % 32) - 16,
+						(int)((x >> 32) % 8));
+					break;
+				case 6:
+					fprintf(f, "\tsw %%r%d, $0%o(%%r%d)  # store\n",
+						(int)((x >> 16) % 8), (unsigned)((x >> 24) % 15),
+						(int)((x >> 32) % 8));
+					break;
+				case 7:
+					fprintf(f, "\tmovhi %%r%d, $0x%02x\n\tmovlo %%r%d, $%d\n",
+						(int)((x >> 16) % 7) + 1, (unsigned)((x >> 24) & 0xFF),
+						(int)((x >> 16) % 7) + 1, (int)((x >> 32) & 0xFF));
+					break;
+			}
+		}
+
+		/* A loop back and a forward reference. */
+		x = xorshift64(&seed);
+		fprintf(f, "\t%s block_%zu    # loop\n", bra[x % 4], block);
+		fprintf(f, "\t%s block_%zu\n\n", bra[(x >> 8) % 4], block + 1);
+	}
+	fprintf(f, "block_%zu:\n\tj block_%zu\n", block, block);
+
+	ret = !ferror(f);
+	ret = !fclose(f) && ret;
+	if (!ret)
+		fprintf(stderr, "Unable to write %s\n", file);
+	return (ret);
+}
+
+/**
+ * @brief Emits an error message, as tas does.
+ */
+static void print_diag(void *data, const char *file, int line,
+	const char *msg)
+{
+	((void)data);
+	fprintf(stderr, "%s:%d: Error: %s\n", file, line, msg);
+}
+
+/**
+ * @brief Times tas against the source @p file: assembling (from
+ * the file) and the hex output formatting, and prints the
+ * throughput in lines/s, instructions/s and MB/s.
+ *
+ * @param file Source file.
+ *
+ * @return Returns 1 if success and 0 otherwise.
+ */
+static int bench_tas(const char *file)
+{
+	double t_asm, t_all;  /* Best times.      */
+	struct tas_image img; /* Assembled image. */
+	uint64_t bytes;       /* Source size.     */
+	uint64_t lines;       /* Source lines.    */
+	size_t insns;         /* Image words.     */
+	size_t out_size;      /* Output size.     */
+	double start;         /* Start time.      */
+	double t;             /* Round time.      */
+	char *out;            /* Output buffer.   */
+	FILE *f;              /* Source file.     */
+	int c;                /* Current char.    */
+
+	if (!(f = fopen(file, "r")))
+	{
+		perror(file);
+		return (0);
+	}
+	bytes = lines = 0;
+	while ((c = getc(f)) != EOF)
+	{
+		bytes++;
+		lines += (c == '\n');
+	}
+	fclose(f);
+
+	insns = 0;
+	t_asm = t_all = 1e9;
+	for (int r = 0; r < rounds; r++)
+	{
+		start = now();
+		if (tas_assemble_file(file, print_diag, NULL, &img) < 0)
+			return (0);
+		t = now() - start;
+		if (t < t_asm)
+			t_asm = t;
+
+		if (tas_format_image(&img, TAS_FMT_HEX, file, &out, &out_size) < 0)
+		{
+			tas_image_free(&img);
+			return (0);
+		}
+		t = now() - start;
+		if (t < t_all)
+			t_all = t;
+
+		insns = img.size;
+		free(out);
+		tas_image_free(&img);
+	}
+
+	printf("%s: %.2f MB, %" PRIu64 " lines, %zu instructions\n", file,
+		bytes / 1048576.0, lines, insns);
+	printf("%-16s %10s %14s %14s %8s\n", "tas", "Time (ms)", "Lines/s",
+		"Insns/s", "MB/s");
+	printf("%-16s %10.2f %14.0f %14.0f %8.1f\n", "assemble", t_asm * 1e3,
+		lines / t_asm, insns / t_asm, bytes / 1048576.0 / t_asm);
+	printf("%-16s %10.2f %14.0f %14.0f %8.1f\n", "+ hex output",
+		t_all * 1e3, lines / t_all, insns / t_all,
+		bytes / 1048576.0 / t_all);
+	return (1);
+}
+
+/**
+ * @brief Shows the usage.
+ *
+ * @param prgname Program name.
+ */
+static void usage(const char *prgname)
+{
+	fprintf(stderr, "Usage: %s [-r rounds]            (micro benchmarks)\n"
+		"       %s -g <file.s> [-s MB]    (generate a synthetic source)\n"
+		"       %s -t <file.s> [-r rounds] (time tas against a source)\n",
+		prgname, prgname, prgname);
+	fprintf(stderr, "Options: \n");
+	fprintf(stderr, "   -r <rounds> Rounds per measure, the best is "
+		"reported (default: %d)\n", ROUNDS);
+	fprintf(stderr, "   -s <MB> Synthetic source size (default: %ld)\n",
+		gen_mb);
+	exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief Parses the command-line arguments.
+ *
+ * @param argc Argument count.
+ * @param argv Argument list.
+ */
+static void parse_args(int argc, char **argv)
+{
+	char *end; /* End of number. */
+	int c;     /* Current arg.   */
+
+	while ((c = getopt(argc, argv, "hg:r:s:t:")) != -1)
+	{
+		switch (c)
+		{
+			case 'g':
+				gen_file = optarg;
+				break;
+			case 't':
+				asm_file = optarg;
+				break;
+			case 'r':
+				rounds = (int)strtol(optarg, &end, 10);
+				if (end == optarg || *end || rounds < 1)
+					usage(argv[0]);
+				break;
+			case 's':
+				gen_mb = strtol(optarg, &end, 10);
+				if (end == optarg || *end || gen_mb < 1)
+					usage(argv[0]);
+				break;
+			default:
+				usage(argv[0]);
+				break;
+		}
+	}
+
+	if (optind < argc || (gen_file && asm_file))
+		usage(argv[0]);
+}
+
+/**
+ * Main
+ */
+int main(int argc, char **argv)
+{
+	int ret; /* Return code. */
+
+	parse_args(argc, argv);
+
+	if (gen_file)
+		ret = generate(gen_file, gen_mb);
+	else if (asm_file)
+		ret = bench_tas(asm_file);
+	else
+		ret = bench_micro();
+
+	return (ret ? EXIT_SUCCESS : EXIT_FAILURE);
+}
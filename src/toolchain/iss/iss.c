@@ -0,0 +1,1131 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Davidson Francis <davidsondfgl@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Tangle instruction-set simulator.
+ *
+ * Runs a memory image (the same ram.hex loaded by the RTL) natively,
+ * without simulating the hardware: every memory word is decoded only
+ * once, into a pre-decoded table, and the main loop just dispatches
+ * over it. Stores re-decode the written word, so self-modifying code
+ * behaves as in the CPU.
+ *
+ * The architectural state (registers, flags, memory) mirrors the RTL,
+ * quirks included:
+ * - LW/SW compute their address with the ALU (ADD), and thus update
+ *   the flags, like any other ADD.
+ * - JAL always writes PC+1 to r7, and register-based JALs jump to r7,
+ *   regardless of the register encoded.
+ * - Writes to r0 are discarded and unknown opcodes are NOPs.
+ *
+ * Optionally, the clock cycles are also accounted, from the state
+ * costs of the selected CPU (see the 'Clock notes' in tangle_decode.v
+ * and tangle_cpu_pipeline.v).
+ *
+ * The performance counters (-p) are read from the same addresses as in
+ * the hardware, but sampled at the beginning of the load, i.e: they
+ * count everything before it.
+ *
+ * The PC profile (-g) holds the cycles spent at each PC, in the format
+ * read by the profiler (toolchain/prof), the startup cycles are
+ * accounted to the first instruction.
+ *
+ * The multi-core SoC (-k, ENABLE_MULTICORE) is simulated as its cores
+ * run: each one with its own memory and the core ID and count in r1
+ * and r2, one after the other. The instructions are then the sum for
+ * all the cores and the cycles, those of the slowest one.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <ctype.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+#include "tas.h"
+#include "cycles.h"
+
+/*
+ * ISS operations, i.e: what the pre-decoded table dispatches on,
+ * AMI and branches follow the opcodes order.
+ */
+enum iss_op
+{
+	OP_OR, OP_AND, OP_XOR, OP_SLL, OP_SLR, OP_NOT, OP_NEG,
+	OP_ADD, OP_SUB, OP_MOV, OP_MOVHI, OP_MOVLO, OP_CMP,
+	OP_JE, OP_JNE, OP_JGS, OP_JGU, OP_JLS, OP_JLU,
+	OP_JGES, OP_JGEU, OP_JLES, OP_JLEU, OP_J, OP_JAL,
+	OP_LW, OP_SW, OP_NOP
+};
+
+/*
+ * Pre-decoded instruction.
+ *
+ * Operands are resolved at decode time: @p src points either to the
+ * source register or to @p imm, and @p dst to the destination register
+ * (or to a sink, if r0). Immediate branches already hold their
+ * (absolute) target in @p imm.
+ */
+struct dinsn
+{
+	const uint16_t *src; /* Source operand / branch target. */
+	uint16_t *dst;       /* Destination register.           */
+	uint16_t imm;        /* Immediate value.                */
+	uint8_t op;          /* Operation, see enum iss_op.     */
+	uint8_t rd;          /* Destination register number.    */
+	uint8_t rs;          /* Source register number.         */
+	uint8_t cycles;      /* Static cost, in clock cycles.   */
+	uint8_t taken;       /* Taken branches cost.            */
+};
+
+/*
+ * Clock cycles, per instruction class.
+ */
+struct cost_model
+{
+	const char *name;
+	uint8_t startup;   /* Reset to first instruction.      */
+	uint8_t ami;       /* ALU/Mov.                         */
+	uint8_t bra;       /* Not taken branch.                */
+	uint8_t bra_taken; /* Taken branch/jump.               */
+	uint8_t lw;        /* Load.                            */
+	uint8_t sw;        /* Store.                           */
+	uint8_t sw_hit;    /* Store into the next instruction. */
+	uint8_t shift;     /* Shift, w/o the shifting cycles.  */
+	uint8_t nop;       /* Unknown opcodes.                 */
+	uint8_t stall;     /* Startup cycles as memory stalls. */
+};
+
+/* Multi-state FSM CPU (tangle_cpu.v). */
+static const struct cost_model fsm_model =
+	{"fsm", FSM_STARTUP, FSM_AMI, FSM_BRA, FSM_BRA_TAKEN, FSM_LW,
+	FSM_SW, FSM_SW_HIT, FSM_SHIFT, FSM_NOP, 0};
+
+/* Pipelined CPU (tangle_cpu_pipeline.v). */
+static const struct cost_model pipeline_model =
+	{"pipeline", PIPE_STARTUP, PIPE_AMI, PIPE_BRA, PIPE_BRA_TAKEN,
+	PIPE_LW, PIPE_SW, PIPE_SW_HIT, PIPE_SHIFT, PIPE_NOP, 1};
+
+/*
+ * Simulator state.
+ */
+struct iss
+{
+	/* Architectural state. */
+	uint16_t regs[8];
+	uint16_t sink;
+	uint8_t zf, sf, cf, of;
+	uint16_t pc;
+
+	/* Memory and its pre-decoded counterpart. */
+	uint16_t *mem;
+	struct dinsn *dec;
+	uint16_t mask;
+
+	/*
+	 * Cost model, extra cycles and ALU stall cycles (i.e: all
+	 * but the AMI cost) per shift amount.
+	 */
+	struct cost_model cost;
+	uint8_t shift_cost[16];
+	uint8_t shift_stall[16];
+
+	/* Stats. */
+	uint64_t insns;
+	uint64_t cycles;
+	uint64_t alu_stalls;
+	int reason; /* Exit reason, last run. */
+
+	/* PC profile, cycles per PC, if enabled. */
+	uint64_t *prof;
+};
+
+/* Exit reasons. */
+#define EXIT_HALT   0 /* Jump to itself.        */
+#define EXIT_PC     1 /* Exit PC reached.       */
+#define EXIT_INSNS  2 /* Instruction limit hit. */
+#define EXIT_CYCLES 3 /* Cycle limit hit.       */
+
+/* Options. */
+static char *input_file;
+static char *dump_file;
+static char *prof_file;
+static const struct cost_model *model = &fsm_model;
+static int dual_port;
+static int barrel_shifter;
+static int perf_counters;
+static int branch_prediction;
+static int regfile_bypass;
+static int ram_size_log = RAM_SIZE_LOG;
+static int ncores;
+static uint64_t max_insns;
+static uint64_t max_cycles;
+static long exit_pc = -1;
+static int quiet;
+static int summary;
+
+/* Sign extensions. */
+#define SEXT5(i) ((uint16_t)(((i) & 0x10) ? ((i) | 0xFFE0) : ((i) & 0x1F)))
+#define SEXT8(i) ((uint16_t)(((i) & 0x80) ? ((i) | 0xFF00) : ((i) & 0xFF)))
+
+/**
+ * Pre-decodes the memory word at @p addr.
+ *
+ * @param iss Simulator state.
+ * @param addr Memory address.
+ */
+static void predecode(struct iss *iss, uint16_t addr)
+{
+	struct dinsn *d; /* Decoded instruction. */
+	uint16_t insn;   /* Raw instruction.     */
+	uint8_t opc;     /* Opcode.              */
+
+	d    = &iss->dec[addr];
+	insn = iss->mem[addr];
+	opc  = INSN_GET_OPCODE(insn);
+
+	d->rd  = (insn >> 8) & 7;
+	d->rs  = (insn >> 5) & 7;
+	d->dst = d->rd ? &iss->regs[d->rd] : &iss->sink;
+
+	/* AMI: Reg/Reg if RS != 0, otherwise Reg/Imm (5-bit, unsigned). */
+	if (opc <= OPC_CMP)
+	{
+		d->op     = OP_OR + opc;
+		d->imm    = insn & 0x1F;
+		d->src    = d->rs ? &iss->regs[d->rs] : &d->imm;
+		d->cycles = iss->cost.ami;
+
+		/* MOVHI/MOVLO: always Reg/Imm (8-bit, unsigned). */
+		if (opc == OPC_MOVHI || opc == OPC_MOVLO)
+		{
+			d->imm = insn & 0xFF;
+			d->src = &d->imm;
+		}
+		else if (opc == OPC_SLL || opc == OPC_SLR)
+			d->cycles = iss->cost.shift;
+	}
+
+	/*
+	 * Branches: PC-relative if RD == 0, absolute (register)
+	 * otherwise.
+	 */
+	else if (opc <= OPC_JAL)
+	{
+		d->op     = OP_JE + (opc - OPC_JE);
+		d->imm    = (addr + SEXT8(insn)) & iss->mask;
+		d->cycles = iss->cost.bra;
+		d->taken  = iss->cost.bra_taken;
+
+		/*
+		 * Static prediction (FSM only): immediate J/JAL and backward
+		 * branches are predicted as taken, and skip the memory wait,
+		 * mispredictions cost what a taken branch would.
+		 */
+		if (branch_prediction && model == &fsm_model && !d->rd &&
+			(opc == OPC_J || opc == OPC_JAL || (insn & 0x80)))
+		{
+			d->cycles = iss->cost.bra_taken;
+			d->taken  = iss->cost.bra_taken - 1;
+		}
+
+		if (!d->rd)
+			d->src = &d->imm;
+		else
+			d->src = &iss->regs[opc == OPC_JAL ? 7 : d->rd];
+
+		if (opc == OPC_JAL)
+			d->dst = &iss->regs[7];
+	}
+
+	/* Load/Store: RD, Imm (5-bit, signed) (RS). */
+	else if (opc <= OPC_SW)
+	{
+		d->op     = opc == OPC_LW ? OP_LW : OP_SW;
+		d->imm    = SEXT5(insn);
+		d->src    = &iss->regs[d->rs];
+		d->cycles = opc == OPC_LW ? iss->cost.lw : iss->cost.sw;
+	}
+
+	/* Unknown. */
+	else
+	{
+		d->op     = OP_NOP;
+		d->cycles = iss->cost.nop;
+	}
+}
+
+/**
+ * Initializes the simulator, with a zeroed memory of
+ * 2^@p size_log words.
+ *
+ * @param iss Simulator state.
+ * @param size_log Memory size, log2.
+ * @param prof Allocates the PC profile, if not 0.
+ *
+ * @return Returns 1 if success, 0 otherwise.
+ */
+static int iss_init(struct iss *iss, int size_log, int prof)
+{
+	size_t size;
+
+	memset(iss, 0, sizeof(*iss));
+	size      = (size_t)1 << size_log;
+	iss->mask = (uint16_t)(size - 1);
+	iss->mem  = calloc(size, sizeof(*iss->mem));
+	iss->dec  = calloc(size, sizeof(*iss->dec));
+	if (prof)
+		iss->prof = calloc(size, sizeof(*iss->prof));
+	if (!iss->mem || !iss->dec || (prof && !iss->prof))
+	{
+		fprintf(stderr, "Unable to allocate memory!\n");
+		return (0);
+	}
+
+	/*
+	 * Cost model: the iterative shifter adds shift_amt/4 +
+	 * shift_amt%4 cycles, the barrel one, none.
+	 */
+	iss->cost = *model;
+	if (dual_port)
+	{
+		if (model == &fsm_model)
+			iss->cost.lw--;
+		else
+			iss->cost.sw--;
+	}
+
+	/*
+	 * Register file bypass: the FSM skips the write-back in all but
+	 * taken branches and single-port stores, and the loads no
+	 * longer stall the pipeline (dual-port).
+	 */
+	if (regfile_bypass)
+	{
+		if (model == &fsm_model)
+		{
+			iss->cost.ami--;
+			iss->cost.bra--;
+			iss->cost.lw--;
+			iss->cost.shift--;
+			iss->cost.nop--;
+			if (dual_port)
+			{
+				iss->cost.sw--;
+				iss->cost.sw_hit--;
+			}
+		}
+		else if (dual_port)
+			iss->cost.lw--;
+	}
+
+	if (barrel_shifter)
+		iss->cost.shift = iss->cost.ami;
+	for (int i = 0; i < 16; i++)
+	{
+		iss->shift_cost[i]  = barrel_shifter ? 0 : SHIFT_CYCLES(i);
+		iss->shift_stall[i] = iss->shift_cost[i] +
+			(iss->cost.shift - iss->cost.ami);
+	}
+
+	return (1);
+}
+
+/**
+ * Releases the simulator resources.
+ *
+ * @param iss Simulator state.
+ */
+static void iss_finish(struct iss *iss)
+{
+	free(iss->mem);
+	free(iss->dec);
+	free(iss->prof);
+}
+
+/**
+ * Loads a memory image in the $readmemh format, i.e: hexadecimal
+ * words separated by whitespaces, '//' and block comments, and
+ * '@addr' address changes.
+ *
+ * @param iss Simulator state.
+ * @param file Image file.
+ *
+ * @return Returns 1 if success, 0 otherwise.
+ */
+static int load_hex(struct iss *iss, const char *file)
+{
+	unsigned long word; /* Current word.    */
+	size_t addr;        /* Current address. */
+	size_t size;        /* Memory size.     */
+	char *p, *end;      /* Parse pointers.  */
+	FILE *f;
+	char line[256];
+	int ln;
+	int comment;
+
+	if (!(f = fopen(file, "r")))
+	{
+		fprintf(stderr, "Unable to open %s: %s\n", file, strerror(errno));
+		return (0);
+	}
+
+	size    = (size_t)iss->mask + 1;
+	addr    = 0;
+	comment = 0;
+
+	for (ln = 1; fgets(line, sizeof line, f); ln++)
+	{
+		for (p = line; *p; )
+		{
+			/* Block comments. */
+			if (comment)
+			{
+				if (!(p = strstr(p, "*/")))
+					break;
+				p += 2;
+				comment = 0;
+				continue;
+			}
+
+			if (isspace((unsigned char)*p))
+			{
+				p++;
+				continue;
+			}
+			if (p[0] == '/' && p[1] == '/')
+				break;
+			if (p[0] == '/' && p[1] == '*')
+			{
+				p += 2;
+				comment = 1;
+				continue;
+			}
+
+			/* Address or data word. */
+			errno = 0;
+			word  = strtoul(p + (*p == '@'), &end, 16);
+			if (end == p + (*p == '@') || errno ||
+				(*end && !isspace((unsigned char)*end) && *end != '/'))
+			{
+				fprintf(stderr, "%s:%d: invalid word!\n", file, ln);
+				goto err;
+			}
+
+			if (*p == '@')
+				addr = word;
+			else
+			{
+				if (word > 0xFFFF)
+				{
+					fprintf(stderr, "%s:%d: word out of range!\n", file, ln);
+					goto err;
+				}
+				if (addr >= size)
+				{
+					fprintf(stderr, "%s:%d: image is bigger than the "
+						"memory (%zu words)!\n", file, ln, size);
+					goto err;
+				}
+				iss->mem[addr++] = (uint16_t)word;
+			}
+			p = end;
+		}
+	}
+
+	fclose(f);
+
+	for (addr = 0; addr < size; addr++)
+		predecode(iss, (uint16_t)addr);
+
+	return (1);
+err:
+	fclose(f);
+	return (0);
+}
+
+/**
+ * Reads a performance counter.
+ *
+ * Memory stalls are whatever is left after the AMI cost of every
+ * instruction and the ALU stalls, i.e: STATE_WAIT_MEM in the FSM
+ * CPU and the empty execute stage clocks in the pipeline.
+ *
+ * @param iss Simulator state.
+ * @param counter Counter, 0: cycles, 1: retired, 2: memory stalls,
+ * 3: ALU stalls.
+ * @param insns Retired instructions.
+ * @param cycles Elapsed cycles.
+ *
+ * @return Returns the counter value.
+ */
+static uint64_t perf_counter(const struct iss *iss, int counter,
+	uint64_t insns, uint64_t cycles)
+{
+	switch (counter)
+	{
+		case 0:
+			return (cycles);
+		case 1:
+			return (insns);
+		case 2:
+			return (cycles - (iss->cost.startup - iss->cost.stall) -
+				insns * iss->cost.ami - iss->alu_stalls);
+		default:
+			return (iss->alu_stalls);
+	}
+}
+
+/* Flags updates. */
+#define SET_ZS(v) \
+	do { \
+		zf = ((v) == 0); \
+		sf = (v) >> 15; \
+	} while (0)
+
+#define SET_LOGIC(v) \
+	do { \
+		SET_ZS(v); \
+		cf = 0; \
+		of = 0; \
+	} while (0)
+
+#define SET_ADD(a, b, r) \
+	do { \
+		cf = (r) >> 16; \
+		SET_ZS((uint16_t)(r)); \
+		of = ((((a) ^ (r)) & ~((a) ^ (b))) >> 15) & 1; \
+	} while (0)
+
+#define SET_SUB(a, b, r) \
+	do { \
+		cf = ((r) >> 16) & 1; \
+		SET_ZS((uint16_t)(r)); \
+		of = ((((a) ^ (r)) & ((a) ^ (b))) >> 15) & 1; \
+	} while (0)
+
+/* Conditional branch. */
+#define BRANCH(cond) \
+	do { \
+		if (cond) \
+			goto taken; \
+		pc = (pc + 1) & mask; \
+		goto next; \
+	} while (0)
+
+/**
+ * Runs the simulation until an exit condition is met.
+ *
+ * @param iss Simulator state.
+ *
+ * @return Returns the exit reason.
+ */
+static int iss_run(struct iss *iss)
+{
+	const struct dinsn *d; /* Current instruction. */
+	uint64_t insn_limit;   /* Instructions limit.  */
+	uint64_t cycle_limit;  /* Cycles limit.        */
+	uint64_t prof_last;    /* Cycles, last insn.   */
+	uint64_t *prof;        /* PC profile.          */
+	uint64_t insns;
+	uint64_t cycles;
+	uint32_t a, b, r;
+	uint16_t target;
+	uint16_t mask;
+	uint16_t addr;
+	uint16_t pc;
+	uint8_t zf, sf, cf, of;
+	uint16_t *regs;
+	int reason;
+
+	insn_limit  = max_insns  ? max_insns  : UINT64_MAX;
+	cycle_limit = max_cycles ? max_cycles : UINT64_MAX;
+
+	regs   = iss->regs;
+	mask   = iss->mask;
+	pc     = iss->pc;
+	insns  = iss->insns;
+	cycles = iss->cycles + iss->cost.startup;
+	zf = iss->zf; sf = iss->sf; cf = iss->cf; of = iss->of;
+
+	prof      = iss->prof;
+	prof_last = iss->cycles;
+	d         = NULL;
+
+	for (;;)
+	{
+		/* Profile: the previous instruction is complete. */
+		if (prof && d)
+		{
+			prof[d - iss->dec] += cycles - prof_last;
+			prof_last = cycles;
+		}
+
+		d = &iss->dec[pc];
+		cycles += d->cycles;
+		insns++;
+
+		switch (d->op)
+		{
+			/* Logical. */
+			case OP_OR:
+				r = regs[d->rd] | *d->src;
+				SET_LOGIC(r);
+				*d->dst = r;
+				break;
+			case OP_AND:
+				r = regs[d->rd] & *d->src;
+				SET_LOGIC(r);
+				*d->dst = r;
+				break;
+			case OP_XOR:
+				r = regs[d->rd] ^ *d->src;
+				SET_LOGIC(r);
+				*d->dst = r;
+				break;
+			case OP_SLL:
+				b = *d->src & 0xF;
+				cycles += iss->shift_cost[b];
+				iss->alu_stalls += iss->shift_stall[b];
+				*d->dst = regs[d->rd] << b;
+				break;
+			case OP_SLR:
+				b = *d->src & 0xF;
+				cycles += iss->shift_cost[b];
+				iss->alu_stalls += iss->shift_stall[b];
+				*d->dst = regs[d->rd] >> b;
+				break;
+			case OP_NOT:
+				*d->dst = ~regs[d->rd];
+				break;
+			case OP_NEG:
+				*d->dst = -regs[d->rd];
+				break;
+
+			/* Arithmetic. */
+			case OP_ADD:
+				a = regs[d->rd];
+				b = *d->src;
+				r = a + b;
+				SET_ADD(a, b, r);
+				*d->dst = r;
+				break;
+			case OP_SUB:
+			case OP_CMP:
+				a = regs[d->rd];
+				b = *d->src;
+				r = a - b;
+				SET_SUB(a, b, r);
+				if (d->op == OP_SUB)
+					*d->dst = r;
+				break;
+
+			/* Move. */
+			case OP_MOV:
+				*d->dst = *d->src;
+				break;
+			case OP_MOVHI:
+				*d->dst = *d->src << 8;
+				break;
+			case OP_MOVLO:
+				*d->dst = regs[d->rd] | *d->src;
+				break;
+
+			/* Branches. */
+			case OP_JE:   BRANCH(zf);
+			case OP_JNE:  BRANCH(!zf);
+			case OP_JGS:  BRANCH(!zf && sf == of);
+			case OP_JGU:  BRANCH(!cf && !zf);
+			case OP_JLS:  BRANCH(sf != of);
+			case OP_JLU:  BRANCH(cf);
+			case OP_JGES: BRANCH(sf == of);
+			case OP_JGEU: BRANCH(!cf);
+			case OP_JLES: BRANCH(zf || sf != of);
+			case OP_JLEU: BRANCH(cf || zf);
+			case OP_J:
+				goto taken;
+			case OP_JAL:
+				target = *d->src & mask;
+				*d->dst = (pc + 1) & mask;
+				goto jump;
+
+			/* Memory, the address goes through the ALU (ADD). */
+			case OP_LW:
+			case OP_SW:
+				a = *d->src;
+				b = d->imm;
+				r = a + b;
+				SET_ADD(a, b, r);
+
+				/* Performance counters, read-only. */
+				if (perf_counters && (r & PERF_MASK) == PERF_BASE)
+				{
+					if (d->op == OP_LW)
+					{
+						b = (uint32_t)perf_counter(iss, (r >> 1) & 3,
+							insns - 1, cycles - d->cycles);
+						*d->dst = (r & 1) ? b >> 16 : b;
+					}
+					break;
+				}
+
+				addr = r & mask;
+				if (d->op == OP_LW)
+					*d->dst = iss->mem[addr];
+				else
+				{
+					iss->mem[addr] = regs[d->rd];
+					predecode(iss, addr);
+					if (addr == ((pc + 1) & mask))
+						cycles += iss->cost.sw_hit - iss->cost.sw;
+				}
+				break;
+
+			default:
+				break;
+		}
+
+		/* Sequential instructions. */
+		pc = (pc + 1) & mask;
+		goto next;
+
+	taken:
+		target = *d->src & mask;
+	jump:
+		cycles = cycles - d->cycles + d->taken;
+		if (target == pc)
+		{
+			reason = EXIT_HALT;
+			break;
+		}
+		pc = target;
+
+	next:
+		if (pc == exit_pc)
+		{
+			reason = EXIT_PC;
+			break;
+		}
+		if (insns >= insn_limit)
+		{
+			reason = EXIT_INSNS;
+			break;
+		}
+		if (cycles >= cycle_limit)
+		{
+			reason = EXIT_CYCLES;
+			break;
+		}
+	}
+
+	if (prof)
+		prof[d - iss->dec] += cycles - prof_last;
+
+	iss->pc     = pc;
+	iss->insns  = insns;
+	iss->cycles = cycles;
+	iss->zf = zf; iss->sf = sf; iss->cf = cf; iss->of = of;
+	return (reason);
+}
+
+/**
+ * Dumps the memory in the same format as the input image, one
+ * word per line.
+ *
+ * @param iss Simulator state.
+ * @param file Output file, '-' for stdout.
+ *
+ * @return Returns 1 if success, 0 otherwise.
+ */
+static int dump_hex(const struct iss *iss, const char *file)
+{
+	FILE *f;
+	int ret;
+
+	if (!strcmp(file, "-"))
+		f = stdout;
+	else if (!(f = fopen(file, "w")))
+	{
+		fprintf(stderr, "Unable to open %s: %s\n", file, strerror(errno));
+		return (0);
+	}
+
+	for (size_t i = 0; i <= iss->mask; i++)
+		fprintf(f, "%04x\n", iss->mem[i]);
+
+	ret = !ferror(f);
+	if (f != stdout)
+		ret = !fclose(f) && ret;
+	if (!ret)
+		fprintf(stderr, "Unable to write %s\n", file);
+	return (ret);
+}
+
+/**
+ * Dumps the PC profile: one '<pc> <cycles>' line (hex and decimal)
+ * per PC with cycles, as the RTL testbenches do.
+ *
+ * @param iss Simulator state.
+ * @param file Output file, '-' for stdout.
+ *
+ * @return Returns 1 if success, 0 otherwise.
+ */
+static int dump_prof(const struct iss *iss, const char *file)
+{
+	FILE *f;
+	int ret;
+
+	if (!strcmp(file, "-"))
+		f = stdout;
+	else if (!(f = fopen(file, "w")))
+	{
+		fprintf(stderr, "Unable to open %s: %s\n", file, strerror(errno));
+		return (0);
+	}
+
+	for (size_t i = 0; i <= iss->mask; i++)
+		if (iss->prof[i])
+			fprintf(f, "%04zx %" PRIu64 "\n", i, iss->prof[i]);
+
+	ret = !ferror(f);
+	if (f != stdout)
+		ret = !fclose(f) && ret;
+	if (!ret)
+		fprintf(stderr, "Unable to write %s\n", file);
+	return (ret);
+}
+
+/* Exit reasons strings. */
+static const char *const reasons[] = {
+	"halt (jump to itself)",
+	"exit PC reached",
+	"instruction limit reached",
+	"cycle limit reached"
+};
+
+/**
+ * Prints the exit reason, stats and final CPU state.
+ *
+ * @param iss Simulator state.
+ * @param reason Exit reason.
+ * @param secs Host (elapsed) time, in seconds.
+ */
+static void print_state(const struct iss *iss, int reason, double secs)
+{
+	printf("Stopped: %s, PC: 0x%04x\n", reasons[reason], iss->pc);
+	printf("Instructions: %" PRIu64 "\n", iss->insns);
+	printf("Cycles (%s%s%s%s%s): %" PRIu64 " (CPI: %.2f)\n",
+		iss->cost.name,
+		dual_port ? ", dual-port" : "",
+		barrel_shifter ? ", barrel" : "",
+		branch_prediction ? ", prediction" : "",
+		regfile_bypass ? ", bypass" : "",
+		iss->cycles,
+		iss->insns ? (double)iss->cycles / iss->insns : 0.0);
+	printf("Stalls: memory: %" PRIu64 ", ALU: %" PRIu64 "\n",
+		perf_counter(iss, 2, iss->insns, iss->cycles), iss->alu_stalls);
+
+	if (secs > 0)
+		printf("Host time: %.3f s (%.2f MIPS)\n", secs,
+			iss->insns / secs / 1e6);
+
+	for (int i = 0; i < 8; i++)
+		printf("r%d: 0x%04x%s", i, iss->regs[i], (i % 4) == 3 ? "\n" : "  ");
+
+	printf("zf: %d  sf: %d  cf: %d  of: %d\n",
+		iss->zf, iss->sf, iss->cf, iss->of);
+}
+
+/**
+ * Prints a single line summary: the input file name (w/o the
+ * extension), retired instructions, cycles, CPI and host time (ms),
+ * followed by the exit reason, if not a halt. Used by the benchmarks
+ * (src/bench).
+ *
+ * @param insns Retired instructions.
+ * @param cycles Clock cycles.
+ * @param reason Exit reason.
+ * @param secs Host (elapsed) time, in seconds.
+ */
+static void print_summary(uint64_t insns, uint64_t cycles, int reason,
+	double secs)
+{
+	const char *name; /* File name, w/o the path. */
+	const char *ext;  /* File extension.          */
+
+	name = strrchr(input_file, '/');
+	name = name ? name + 1 : input_file;
+	ext  = strrchr(name, '.');
+	if (!ext || ext == name)
+		ext = name + strlen(name);
+
+	printf("%-12.*s %10" PRIu64 " %10" PRIu64 " %6.2f %10.3f%s%s\n",
+		(int)(ext - name), name, insns, cycles,
+		insns ? (double)cycles / insns : 0.0,
+		secs * 1e3,
+		reason != EXIT_HALT ? "  " : "",
+		reason != EXIT_HALT ? reasons[reason] : "");
+}
+
+/**
+ * Shows the usage.
+ *
+ * @param prgname Program name.
+ */
+static void usage(const char *prgname)
+{
+	fprintf(stderr, "Usage: %s [options] <ram.hex>\n", prgname);
+	fprintf(stderr, "Options: \n");
+	fprintf(stderr, "   -m <model> Cycle model: fsm (default) or "
+		"pipeline\n");
+	fprintf(stderr, "   -d Dual-port memory (ENABLE_DUAL_PORT_RAM)\n");
+	fprintf(stderr, "   -b Barrel shifter (ENABLE_BARREL_SHIFTER)\n");
+	fprintf(stderr, "   -p Performance counters (ENABLE_PERF_COUNTERS)\n");
+	fprintf(stderr, "   -s Static branch prediction "
+		"(ENABLE_BRANCH_PREDICTION, fsm only)\n");
+	fprintf(stderr, "   -w Register file bypass (ENABLE_REGFILE_BYPASS)\n");
+	fprintf(stderr, "   -r <log2> Memory size, in words (default: %d)\n",
+		RAM_SIZE_LOG);
+	fprintf(stderr, "   -k <cores> Multi-core SoC (ENABLE_MULTICORE, "
+		"NCORES=<cores>)\n");
+	fprintf(stderr, "   -n <insns> Stop after <insns> instructions\n");
+	fprintf(stderr, "   -c <cycles> Stop after <cycles> clock cycles\n");
+	fprintf(stderr, "   -e <pc> Stop when reaching <pc>\n");
+	fprintf(stderr, "   -o <file> Dump the memory (core 0) at exit "
+		"('-' for stdout)\n");
+	fprintf(stderr, "   -g <file> Dump the PC profile (cycles per PC, "
+		"core 0) at exit\n");
+	fprintf(stderr, "   -t Print a single line summary (name, insns, "
+		"cycles, CPI, host ms)\n");
+	fprintf(stderr, "   -q Quiet, do not print the final state\n\n");
+	fprintf(stderr, "The simulation always stops in a jump to "
+		"itself (halt)\n");
+	exit(EXIT_FAILURE);
+}
+
+/**
+ * Parses an unsigned number (decimal, hex or octal).
+ *
+ * @param str Number string.
+ * @param out Parsed number.
+ *
+ * @return Returns 1 if success, 0 otherwise.
+ */
+static int parse_u64(const char *str, uint64_t *out)
+{
+	char *end;
+
+	errno = 0;
+	if (*str == '-')
+		return (0);
+	*out = strtoull(str, &end, 0);
+	return (!errno && end != str && !*end);
+}
+
+/**
+ * Parses the command-line arguments.
+ *
+ * @param argc Argument count.
+ * @param argv Argument list.
+ *
+ * @return Returns 1 if success, exits otherwise.
+ */
+static int parse_args(int argc, char **argv)
+{
+	uint64_t num; /* Parsed number. */
+	int c;        /* Current arg.   */
+
+	while ((c = getopt(argc, argv, "hbdpqstwc:e:g:k:m:n:o:r:")) != -1)
+	{
+		switch (c)
+		{
+			case 'b':
+				barrel_shifter = 1;
+				break;
+			case 'd':
+				dual_port = 1;
+				break;
+			case 'p':
+				perf_counters = 1;
+				break;
+			case 's':
+				branch_prediction = 1;
+				break;
+			case 'w':
+				regfile_bypass = 1;
+				break;
+			case 'q':
+				quiet = 1;
+				break;
+			case 't':
+				summary = 1;
+				break;
+			case 'c':
+				if (!parse_u64(optarg, &max_cycles))
+					usage(argv[0]);
+				break;
+			case 'e':
+				if (!parse_u64(optarg, &num) || num > 0xFFFF)
+					usage(argv[0]);
+				exit_pc = (long)num;
+				break;
+			case 'g':
+				prof_file = optarg;
+				break;
+			case 'k':
+				if (!parse_u64(optarg, &num) || num < 1 || num > 16)
+					usage(argv[0]);
+				ncores = (int)num;
+				break;
+			case 'm':
+				if (!strcmp(optarg, "fsm"))
+					model = &fsm_model;
+				else if (!strcmp(optarg, "pipeline"))
+					model = &pipeline_model;
+				else
+				{
+					fprintf(stderr, "Unknown model (%s)!\n", optarg);
+					usage(argv[0]);
+				}
+				break;
+			case 'n':
+				if (!parse_u64(optarg, &max_insns))
+					usage(argv[0]);
+				break;
+			case 'o':
+				dump_file = optarg;
+				break;
+			case 'r':
+				if (!parse_u64(optarg, &num) || num < 1 || num > 16)
+					usage(argv[0]);
+				ram_size_log = (int)num;
+				break;
+			default:
+				usage(argv[0]);
+				break;
+		}
+	}
+
+	/* If not input file available. */
+	if (optind >= argc)
+	{
+		fprintf(stderr, "Expected <ram.hex> after options!\n");
+		usage(argv[0]);
+	}
+
+	input_file = argv[optind];
+	return (1);
+}
+
+/**
+ * Main
+ */
+int main(int argc, char **argv)
+{
+	struct timespec start, end; /* Host time.            */
+	struct iss *iss;            /* Simulators, per core. */
+	uint64_t insns;             /* Insns, all cores.     */
+	uint64_t cycles;            /* Cycles, slowest core. */
+	double secs;                /* Host time.            */
+	int reason;                 /* Exit reason.          */
+	int count;                  /* Core count.           */
+	int ret;                    /* Return code.          */
+
+	/* Parse arguments. */
+	parse_args(argc, argv);
+
+	ret   = 0;
+	count = ncores ? ncores : 1;
+	if (!(iss = calloc(count, sizeof(*iss))))
+	{
+		fprintf(stderr, "Unable to allocate memory!\n");
+		return (EXIT_FAILURE);
+	}
+
+	/* Core ID and count, as loaded by the register file at reset. */
+	for (int i = 0; i < count; i++)
+	{
+		if (!iss_init(&iss[i], ram_size_log, prof_file && !i) ||
+			!load_hex(&iss[i], input_file))
+		{
+			goto out;
+		}
+		if (ncores)
+		{
+			iss[i].regs[1] = (uint16_t)i;
+			iss[i].regs[2] = (uint16_t)ncores;
+		}
+	}
+
+	reason = EXIT_HALT;
+	insns  = 0;
+	cycles = 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (int i = 0; i < count; i++)
+	{
+		iss[i].reason = iss_run(&iss[i]);
+		if (reason == EXIT_HALT)
+			reason = iss[i].reason;
+		insns += iss[i].insns;
+		if (iss[i].cycles > cycles)
+			cycles = iss[i].cycles;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	secs = (end.tv_sec - start.tv_sec) +
+		(end.tv_nsec - start.tv_nsec) / 1e9;
+
+	if (summary)
+		print_summary(insns, cycles, reason, secs);
+	else if (!quiet)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			if (ncores)
+				printf("%sCore %d:\n", i ? "\n" : "", i);
+			print_state(&iss[i], iss[i].reason, secs);
+		}
+		if (ncores)
+		{
+			printf("\nAll cores: %" PRIu64 " instructions, %" PRIu64
+				" cycles (%.2f IPC)\n", insns, cycles,
+				cycles ? (double)insns / cycles : 0.0);
+		}
+	}
+
+	ret = 1;
+	if (dump_file)
+		ret = dump_hex(&iss[0], dump_file);
+	if (prof_file)
+		ret = dump_prof(&iss[0], prof_file) && ret;
+out:
+	for (int i = 0; i < count; i++)
+		iss_finish(&iss[i]);
+	free(iss);
+	return (ret ? EXIT_SUCCESS : EXIT_FAILURE);
+}
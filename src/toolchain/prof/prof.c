@@ -0,0 +1,453 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Davidson Francis <davidsondfgl@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Tangle profiler.
+ *
+ * Joins the symbols written by the assembler (tas -y) with a PC
+ * profile, i.e: the cycles spent at each PC, dumped by either the
+ * ISS (iss -g), the Verilator harness (tangle_sim -g) or the SoC
+ * testbench (+profile=<file>), into a flat profile per label and
+ * per source line, hottest first.
+ *
+ * Each PC belongs to the last label defined at or before it.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+
+/* Addresses are 16-bit at most. */
+#define MAX_ADDR (1 << 16)
+
+/* Label. */
+struct label
+{
+	char *name;
+	size_t addr;
+	uint64_t cycles;
+};
+
+/* Source line. */
+struct line
+{
+	int line;
+	size_t label;
+	uint64_t cycles;
+};
+
+/* Profile state. */
+struct prof
+{
+	/* Symbols. */
+	char *src_name;
+	struct label *labels;
+	size_t nlabels;
+	int lines[MAX_ADDR];
+
+	/* Profile. */
+	uint64_t cycles[MAX_ADDR];
+	uint64_t total;
+
+	/* Source text, if available. */
+	char **src;
+	size_t src_lines;
+};
+
+/* Options. */
+static const char *sym_file;
+static const char *prof_file;
+static size_t max_rows = 20;
+
+/**
+ * Reads the symbols file @p file, see tas_write_symbols().
+ *
+ * @param p Profile state.
+ * @param file Symbols file.
+ *
+ * @return Returns 1 if success, 0 otherwise.
+ */
+static int read_symbols(struct prof *p, const char *file)
+{
+	struct label *labels; /* Realloc'd labels. */
+	char name[256];       /* Label name.       */
+	char buf[512];        /* Current line.     */
+	size_t addr;          /* Address.          */
+	int line;             /* Source line.      */
+	int ln;               /* File line.        */
+	FILE *f;
+
+	if (!(f = fopen(file, "r")))
+	{
+		fprintf(stderr, "Unable to open %s: %s\n", file, strerror(errno));
+		return (0);
+	}
+
+	for (ln = 1; fgets(buf, sizeof buf, f); ln++)
+	{
+		if (buf[0] == 'f' && buf[1] == ' ')
+		{
+			buf[strcspn(buf, "\r\n")] = '\0';
+			free(p->src_name);
+			if ((p->src_name = strdup(buf + 2)) == NULL)
+				goto err;
+		}
+		else if (sscanf(buf, "s %zx %255s", &addr, name) == 2 &&
+			addr < MAX_ADDR)
+		{
+			labels = realloc(p->labels, (p->nlabels + 1) * sizeof(*labels));
+			if (!labels)
+				goto err;
+			p->labels = labels;
+			if ((labels[p->nlabels].name = strdup(name)) == NULL)
+				goto err;
+			labels[p->nlabels].addr     = addr;
+			labels[p->nlabels++].cycles = 0;
+		}
+		else if (sscanf(buf, "l %zx %d", &addr, &line) == 2 &&
+			addr < MAX_ADDR)
+			p->lines[addr] = line;
+		else
+		{
+			fprintf(stderr, "%s:%d: invalid entry!\n", file, ln);
+			goto err;
+		}
+	}
+
+	fclose(f);
+	return (1);
+err:
+	fclose(f);
+	return (0);
+}
+
+/**
+ * Reads the PC profile @p file, i.e: '<pc> <cycles>' lines, hex
+ * and decimal, blank lines and '#' comments are ignored.
+ *
+ * @param p Profile state.
+ * @param file Profile file.
+ *
+ * @return Returns 1 if success, 0 otherwise.
+ */
+static int read_profile(struct prof *p, const char *file)
+{
+	uint64_t cycles; /* PC cycles.   */
+	char buf[256];   /* Line.        */
+	size_t addr;     /* PC.          */
+	char *s;         /* Line start.  */
+	int ln;          /* File line.   */
+	FILE *f;
+
+	if (!(f = fopen(file, "r")))
+	{
+		fprintf(stderr, "Unable to open %s: %s\n", file, strerror(errno));
+		return (0);
+	}
+
+	for (ln = 1; fgets(buf, sizeof buf, f); ln++)
+	{
+		s = buf + strspn(buf, " \t");
+		if (*s == '#' || *s == '\n' || *s == '\r' || !*s)
+			continue;
+
+		if (sscanf(s, "%zx %" SCNu64, &addr, &cycles) != 2 ||
+			addr >= MAX_ADDR)
+		{
+			fprintf(stderr, "%s:%d: invalid entry!\n", file, ln);
+			fclose(f);
+			return (0);
+		}
+		p->cycles[addr] += cycles;
+		p->total        += cycles;
+	}
+
+	fclose(f);
+	return (1);
+}
+
+/**
+ * Reads the source text, if the source named in the symbols
+ * can be opened, otherwise, only the line numbers are shown.
+ *
+ * @param p Profile state.
+ */
+static void read_source(struct prof *p)
+{
+	char **src;  /* Realloc'd lines. */
+	char *buf;   /* Current line.    */
+	size_t len;  /* Buffer size.     */
+	ssize_t r;   /* Line length.     */
+	FILE *f;
+
+	if (!p->src_name || !(f = fopen(p->src_name, "r")))
+		return;
+
+	buf = NULL;
+	len = 0;
+	while ((r = getline(&buf, &len, f)) != -1)
+	{
+		/* Trim. */
+		while (r && (buf[r - 1] == '\n' || buf[r - 1] == '\r'))
+			buf[--r] = '\0';
+
+		src = realloc(p->src, (p->src_lines + 1) * sizeof(*src));
+		if (!src)
+			break;
+		p->src = src;
+		if ((src[p->src_lines] = strdup(buf + strspn(buf, " \t"))) == NULL)
+			break;
+		p->src_lines++;
+	}
+
+	free(buf);
+	fclose(f);
+}
+
+/**
+ * Compares two labels by address.
+ */
+static int cmp_addr(const void *a, const void *b)
+{
+	const struct label *la = a, *lb = b;
+	return ((la->addr > lb->addr) - (la->addr < lb->addr));
+}
+
+/**
+ * Compares two labels by cycles, hottest first.
+ */
+static int cmp_label(const void *a, const void *b)
+{
+	const struct label *la = a, *lb = b;
+	return ((la->cycles < lb->cycles) - (la->cycles > lb->cycles));
+}
+
+/**
+ * Compares two lines by cycles, hottest first.
+ */
+static int cmp_line(const void *a, const void *b)
+{
+	const struct line *la = a, *lb = b;
+	if (la->cycles != lb->cycles)
+		return ((la->cycles < lb->cycles) - (la->cycles > lb->cycles));
+	return ((la->line > lb->line) - (la->line < lb->line));
+}
+
+/**
+ * Builds and prints the flat profiles, per label and per line.
+ *
+ * @param p Profile state.
+ *
+ * @return Returns 1 if success, 0 otherwise.
+ */
+static int report(struct prof *p)
+{
+	struct label *labels; /* Labels + '(start)'.   */
+	struct line *lines;   /* Lines with cycles.    */
+	size_t nlines;        /* Amount of lines.      */
+	size_t lbl;           /* Current label.        */
+	size_t rows;          /* Printed rows.         */
+	double total;         /* Total, for the %.     */
+
+	/* Labels sorted by address, with the code before them. */
+	labels = calloc(p->nlabels + 1, sizeof(*labels));
+	lines  = calloc(MAX_ADDR, sizeof(*lines));
+	if (!labels || !lines)
+	{
+		free(labels);
+		free(lines);
+		fprintf(stderr, "Unable to allocate memory!\n");
+		return (0);
+	}
+
+	qsort(p->labels, p->nlabels, sizeof(*p->labels), cmp_addr);
+	labels[0].name = "(start)";
+	memcpy(labels + 1, p->labels, p->nlabels * sizeof(*labels));
+
+	/* Cycles per label and per line (PCs w/o line count as 0). */
+	nlines = 0;
+	lbl    = 0;
+	for (size_t pc = 0; pc < MAX_ADDR; pc++)
+	{
+		while (lbl < p->nlabels && labels[lbl + 1].addr <= pc)
+			lbl++;
+
+		if (!p->cycles[pc])
+			continue;
+
+		labels[lbl].cycles += p->cycles[pc];
+
+		/* Multi-word lines are contiguous. */
+		if (!nlines || lines[nlines - 1].line != p->lines[pc] ||
+			!p->lines[pc])
+		{
+			lines[nlines].line  = p->lines[pc];
+			lines[nlines].label = lbl;
+			nlines++;
+		}
+		lines[nlines - 1].cycles += p->cycles[pc];
+	}
+
+	total = p->total ? (double)p->total : 1.0;
+	printf("Total: %" PRIu64 " cycles\n\n", p->total);
+
+	/* Per label. */
+	printf("Flat profile, per label:\n");
+	printf("%7s %12s  %s\n", "%time", "cycles", "label");
+	qsort(labels, p->nlabels + 1, sizeof(*labels), cmp_label);
+	for (size_t i = 0; i <= p->nlabels && labels[i].cycles; i++)
+		printf("%7.2f %12" PRIu64 "  %s\n", labels[i].cycles * 100.0 / total,
+			labels[i].cycles, labels[i].name);
+
+	/*
+	 * Per line, the label indexes are from before the sort, so the
+	 * names are taken from the symbols (sorted by address).
+	 */
+	printf("\nFlat profile, per line:\n");
+	printf("%7s %12s %6s  %-16s %s\n", "%time", "cycles", "line", "label",
+		"source");
+	qsort(lines, nlines, sizeof(*lines), cmp_line);
+	for (rows = 0; rows < nlines && (!max_rows || rows < max_rows); rows++)
+	{
+		printf("%7.2f %12" PRIu64 " ", lines[rows].cycles * 100.0 / total,
+			lines[rows].cycles);
+
+		if (lines[rows].line)
+			printf("%6d", lines[rows].line);
+		else
+			printf("%6s", "-");
+
+		printf("  %-16s %s\n", lines[rows].label ?
+			p->labels[lines[rows].label - 1].name : "(start)",
+			lines[rows].line > 0 &&
+			(size_t)lines[rows].line <= p->src_lines ?
+			p->src[lines[rows].line - 1] : "");
+	}
+
+	free(labels);
+	free(lines);
+	return (1);
+}
+
+/**
+ * Releases the profile state.
+ *
+ * @param p Profile state.
+ */
+static void prof_finish(struct prof *p)
+{
+	for (size_t i = 0; i < p->nlabels; i++)
+		free(p->labels[i].name);
+	for (size_t i = 0; i < p->src_lines; i++)
+		free(p->src[i]);
+	free(p->labels);
+	free(p->src);
+	free(p->src_name);
+	free(p);
+}
+
+/**
+ * Shows the usage.
+ *
+ * @param prgname Program name.
+ */
+static void usage(const char *prgname)
+{
+	fprintf(stderr, "Usage: %s [options] <symbols> <profile>\n", prgname);
+	fprintf(stderr, "Options: \n");
+	fprintf(stderr, "   -n <lines> Lines shown in the per line profile "
+		"(default: %zu, 0 = all)\n\n", max_rows);
+	fprintf(stderr, "<symbols> is written by 'tas -y' and <profile> by "
+		"'iss -g',\n'tangle_sim -g' or the SoC testbench "
+		"(+profile=<file>)\n");
+	exit(EXIT_FAILURE);
+}
+
+/**
+ * Parses the command-line arguments.
+ *
+ * @param argc Argument count.
+ * @param argv Argument list.
+ */
+static void parse_args(int argc, char **argv)
+{
+	char *end;
+	int c;
+
+	while ((c = getopt(argc, argv, "hn:")) != -1)
+	{
+		switch (c)
+		{
+			case 'n':
+				errno    = 0;
+				max_rows = strtoul(optarg, &end, 0);
+				if (errno || end == optarg || *end || *optarg == '-')
+					usage(argv[0]);
+				break;
+			default:
+				usage(argv[0]);
+				break;
+		}
+	}
+
+	if (argc - optind != 2)
+	{
+		fprintf(stderr, "Expected <symbols> and <profile> after options!\n");
+		usage(argv[0]);
+	}
+
+	sym_file  = argv[optind];
+	prof_file = argv[optind + 1];
+}
+
+/**
+ * Main
+ */
+int main(int argc, char **argv)
+{
+	struct prof *p; /* Profile state. */
+	int ret;        /* Return code.   */
+
+	parse_args(argc, argv);
+
+	if ((p = calloc(1, sizeof(*p))) == NULL)
+	{
+		fprintf(stderr, "Unable to allocate memory!\n");
+		return (EXIT_FAILURE);
+	}
+
+	ret = 0;
+	if (read_symbols(p, sym_file) && read_profile(p, prof_file))
+	{
+		read_source(p);
+		ret = report(p);
+	}
+
+	prof_finish(p);
+	return (ret ? EXIT_SUCCESS : EXIT_FAILURE);
+}